@@ -0,0 +1,349 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTCheatManager.h"
+
+#include "GGTGameState.h"
+#include "GGTRewindBuffer.h"
+#include "GGTPropReplication.h"
+#include "Props/GGTProp.h"
+#include "Player/GGTCharacter.h"
+#include "Player/GGTPlayerController.h"
+#include "Weapons/GravityGun.h"
+#include "Serialization/ArchiveCountMem.h"
+
+
+/** Memory totals of one group of actors in GGTMemReport */
+struct FGGTMemReportEntry
+{
+	int32 Count;
+	int32 Components;
+	SIZE_T ObjectBytes;
+	SIZE_T ArrayBytes;
+	SIZE_T ComponentObjectBytes;
+	SIZE_T ComponentArrayBytes;
+
+	FGGTMemReportEntry()
+		: Count(0)
+		, Components(0)
+		, ObjectBytes(0)
+		, ArrayBytes(0)
+		, ComponentObjectBytes(0)
+		, ComponentArrayBytes(0)
+	{
+	}
+
+	void Add(AActor* Actor)
+	{
+		Count++;
+		ObjectBytes += Actor->GetClass()->GetStructureSize();
+		ArrayBytes += FArchiveCountMem(Actor).GetMax();
+
+		TInlineComponentArray<UActorComponent*> ActorComponents;
+		Actor->GetComponents(ActorComponents);
+
+		for (UActorComponent* Component : ActorComponents)
+		{
+			Components++;
+			ComponentObjectBytes += Component->GetClass()->GetStructureSize();
+			ComponentArrayBytes += FArchiveCountMem(Component).GetMax();
+		}
+	}
+
+	void Log(const TCHAR* Name) const
+	{
+		const SIZE_T TotalBytes = ObjectBytes + ArrayBytes + ComponentObjectBytes + ComponentArrayBytes;
+		UE_LOG(LogTemp, Log, TEXT("GGTMemReport: %-16s %6d %8.1f %8.1f %6d %8.1f %8.1f %10.0f"), Name, Count,
+			ObjectBytes / 1024.0f, ArrayBytes / 1024.0f, Components, ComponentObjectBytes / 1024.0f, ComponentArrayBytes / 1024.0f,
+			Count > 0 ? (double)TotalBytes / Count : 0.0);
+	}
+};
+
+
+void UGGTCheatManager::GGTRewindTest(int32 NumTraces)
+{
+	UWorld* World = GetWorld();
+	AGGTPlayerController* Controller = Cast<AGGTPlayerController>(GetOuterAPlayerController());
+	APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+	if (Pawn == nullptr || World->GetNetMode() != NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTRewindTest: needs to run on a remote client with a pawn"));
+		return;
+	}
+
+	// Only the moving props show what the rewind does, the ones at rest are in the same place at every time
+	TArray<AGGTProp*> Targets;
+	for (TActorIterator<AGGTProp> It(World); It; ++It)
+	{
+		if (It->PropMesh->GetPhysicsLinearVelocity().SizeSquared() > FMath::Square(100.0f))
+			Targets.Add(*It);
+	}
+
+	if (Targets.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTRewindTest: no props are moving, throw some first"));
+		return;
+	}
+
+	// The traces are reliable RPCs, keep them under what the reliable buffer holds
+	NumTraces = FMath::Clamp(NumTraces, 1, 200);
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	FCollisionQueryParams TraceParams(FName(TEXT("Rewind Test")), false, Pawn);
+	FRandomStream Random(NumTraces);
+
+	// The same server time a fire sends, the time the client sees the world at
+	const float ClientTime = World->GetGameState()->GetServerWorldTimeSeconds();
+
+	int32 Sent = 0;
+	for (int32 i = 0; i < NumTraces; i++)
+	{
+		// Aim at a random point of a prop where the client renders it, and only send the traces the client itself sees hit
+		UPrimitiveComponent* Target = Targets[Random.RandHelper(Targets.Num())]->PropMesh;
+		const FVector AimPoint = Target->Bounds.Origin + (Random.GetUnitVector() * Target->Bounds.SphereRadius * 0.5f);
+		const FVector TraceEnd = ViewLocation + ((AimPoint - ViewLocation).GetSafeNormal() * 10000.0f);
+
+		FHitResult hitResult(ForceInit);
+		if (!World->LineTraceSingleByChannel(hitResult, ViewLocation, TraceEnd, ECC_Visibility, TraceParams) || hitResult.GetComponent() != Target)
+			continue;
+
+		Controller->ServerRewindTestTrace(ViewLocation, TraceEnd, ClientTime, Target);
+		Sent++;
+	}
+
+	// Reliable and in order, so the server has all the traces when it reports
+	Controller->ServerRewindTestReport();
+
+	UE_LOG(LogTemp, Log, TEXT("GGTRewindTest: sent %d traces at %d moving props, the server answers with the results"), Sent, Targets.Num());
+}
+
+void UGGTCheatManager::GGTMemReport()
+{
+	UWorld* World = GetWorld();
+
+	FGGTMemReportEntry HeldGuns;
+	FGGTMemReportEntry FreeGuns;
+	FGGTMemReportEntry OtherWeapons;
+	FGGTMemReportEntry Characters;
+	FGGTMemReportEntry Props;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (AWeaponBase* Weapon = Cast<AWeaponBase>(Actor))
+		{
+			if (!Weapon->IsA<AGravityGun>())
+				OtherWeapons.Add(Weapon);
+			else if (Weapon->GetState() == EWeaponStates::WS_Held)
+				HeldGuns.Add(Weapon);
+			else
+				FreeGuns.Add(Weapon);
+		}
+		else if (Actor->IsA<AGGTCharacter>())
+		{
+			Characters.Add(Actor);
+		}
+		else if (Actor->IsA<AGGTProp>())
+		{
+			Props.Add(Actor);
+		}
+	}
+
+	// Object is the size of the instances, Arrays is what their properties allocate, the same follows for the components they own
+	UE_LOG(LogTemp, Log, TEXT("GGTMemReport: %-16s %6s %8s %8s %6s %8s %8s %10s"), TEXT("Group"), TEXT("Count"), TEXT("ObjKB"), TEXT("ArrKB"), TEXT("Comps"), TEXT("CObjKB"), TEXT("CArrKB"), TEXT("Bytes/Inst"));
+	HeldGuns.Log(TEXT("GravityGun Held"));
+	FreeGuns.Log(TEXT("GravityGun Free"));
+	OtherWeapons.Log(TEXT("Other Weapons"));
+	Characters.Log(TEXT("Characters"));
+	Props.Log(TEXT("Props"));
+}
+
+void UGGTCheatManager::GGTSpawnDroppedWeapons(int32 Count, float Spacing)
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	AGGTCharacter* Character = Controller ? Cast<AGGTCharacter>(Controller->GetPawn()) : nullptr;
+	if (Character == nullptr || Count <= 0)
+		return;
+
+	// Spawn copies of the weapon the player holds, or the one the player starts with
+	UClass* WeaponClass = Character->EquippedWeapon ? Character->EquippedWeapon->GetClass() : Character->StartWeaponClass.Get();
+	if (WeaponClass == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTSpawnDroppedWeapons: the player has no weapon class to spawn"));
+		return;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// A square grid starting in front of the player
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)Count));
+	const FVector Forward = Character->GetActorForwardVector().GetSafeNormal2D();
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+	const FVector Origin = Character->GetActorLocation() + (Forward * Spacing * 2.0f) - (Right * Spacing * GridSize * 0.5f);
+
+	int32 Spawned = 0;
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Location = Origin + (Forward * Spacing * (i / GridSize)) + (Right * Spacing * (i % GridSize));
+
+		AWeaponBase* Weapon = GetWorld()->SpawnActor<AWeaponBase>(WeaponClass, FTransform(Location), SpawnInfo);
+		if (Weapon == nullptr)
+			continue;
+
+		// Keep the physics cost out of the measurement, the weapons wake up when something touches them
+		Weapon->WeaponMesh->PutAllRigidBodiesToSleep();
+		Spawned++;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSpawnDroppedWeapons: spawned %d %s"), Spawned, *WeaponClass->GetName());
+}
+
+void UGGTCheatManager::GGTSpawnProps(int32 Count, float Spacing)
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+	if (Pawn == nullptr || !Pawn->HasAuthority())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTSpawnProps: props can only be spawned on the server"));
+		return;
+	}
+
+	const FVector Forward = Pawn->GetActorForwardVector().GetSafeNormal2D();
+	const int32 Spawned = AGGTProp::SpawnGrid(GetWorld(), Pawn->GetActorLocation() + (Forward * Spacing * 2.0f), Forward, Count, Spacing);
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSpawnProps: spawned %d props"), Spawned);
+}
+
+void UGGTCheatManager::GGTNetReport()
+{
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState == nullptr || GameState->PropReplication == nullptr || !GameState->HasAuthority())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTNetReport: the prop replication only runs on the server"));
+		return;
+	}
+
+	const FGGTPropNetStats Stats = GameState->PropReplication->TakeStats();
+
+	UE_LOG(LogTemp, Log, TEXT("GGTNetReport: over %.1f s"), Stats.Seconds);
+	UE_LOG(LogTemp, Log, TEXT("  %d props, %d dormant, %d held or flying"), Stats.NumProps, Stats.NumDormant, Stats.NumActive);
+	UE_LOG(LogTemp, Log, TEXT("  %d clients, props sent %.0f bytes per client per second on average, %.0f at most"), Stats.NumClients, Stats.AveragePropBytesPerClient, Stats.MaxPropBytesPerClient);
+	UE_LOG(LogTemp, Log, TEXT("  all traffic %.0f bytes per client per second on average, %d at most"), Stats.AverageBytesPerClient, Stats.MaxBytesPerClient);
+	UE_LOG(LogTemp, Log, TEXT("  prop dormancy %.3f ms/s, net driver flush %.3f ms/s with %.0f prop relevancy checks/s"), Stats.DormancyMsPerSecond, Stats.NetFlushMsPerSecond, Stats.RelevancyChecksPerSecond);
+#if GGT_TIME_PROP_RELEVANCY
+	UE_LOG(LogTemp, Log, TEXT("  prop relevancy %.3f ms/s of the flush"), Stats.RelevancyMsPerSecond);
+#endif
+}
+
+void UGGTCheatManager::GGTNetSim(int32 LagMs, int32 LossPercent)
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	if (Controller == nullptr)
+		return;
+
+	// The net driver parses these, the settings apply to the packets this machine sends
+	Controller->ConsoleCommand(FString::Printf(TEXT("Net PktLag=%d"), FMath::Max(LagMs, 0)));
+	Controller->ConsoleCommand(FString::Printf(TEXT("Net PktLoss=%d"), FMath::Clamp(LossPercent, 0, 100)));
+
+	UE_LOG(LogTemp, Log, TEXT("GGTNetSim: %d ms lag, %d%% loss"), LagMs, LossPercent);
+}
+
+void UGGTCheatManager::GGTPredictionReport()
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	AGGTCharacter* Character = Controller ? Cast<AGGTCharacter>(Controller->GetPawn()) : nullptr;
+	if (Character == nullptr)
+		return;
+
+	if (Character->HasAuthority())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTPredictionReport: the player is on the server, nothing is predicted"));
+		return;
+	}
+
+	const FGGTPredictionStats& Stats = Character->GetPredictionStats();
+	const float AverageRoundTrip = Stats.Acks > 0 ? Stats.TotalRoundTrip / Stats.Acks : 0.0f;
+
+	UE_LOG(LogTemp, Log, TEXT("GGTPredictionReport: %d actions predicted, %d answered, %d still waiting"), Stats.Actions, Stats.Acks, FMath::Max(Stats.Actions - Stats.Acks, 0));
+	UE_LOG(LogTemp, Log, TEXT("  round trip %.1f ms on average, %.1f ms at most"), AverageRoundTrip * 1000.0f, Stats.MaxRoundTrip * 1000.0f);
+	UE_LOG(LogTemp, Log, TEXT("  %d fires refused by the server, %d held object corrections"), Stats.Rejected, Stats.Corrections);
+	UE_LOG(LogTemp, Log, TEXT("  %d actions done with another weapon on the server, %d weapon slot corrections"), Stats.WeaponMismatches, Stats.WeaponCorrections);
+
+	Character->ResetPredictionStats();
+}
+
+void UGGTCheatManager::GGTWeaponSwitchTest(int32 NumSwitches)
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	AGGTCharacter* Character = Controller ? Cast<AGGTCharacter>(Controller->GetPawn()) : nullptr;
+	if (Character == nullptr || Character->HasAuthority())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTWeaponSwitchTest: needs to run on a remote client with a character"));
+		return;
+	}
+
+	Character->ResetPredictionStats();
+
+	// Pick up the weapon in front of the player, the fire right after it is done by the server with the new weapon
+	Character->RefreshPickupCandidates();
+	AWeaponBase* Pickup = Character->FindPickupCandidate(300.0f);
+	if (Pickup)
+	{
+		Character->EquipWeapon(Pickup);
+		Character->FireWeapon();
+	}
+
+	int32 NumCarried = 0;
+	for (AWeaponBase* Weapon : Character->WeaponSlots)
+	{
+		if (Weapon)
+			NumCarried++;
+	}
+
+	if (NumCarried + (Pickup ? 1 : 0) < 2)
+		UE_LOG(LogTemp, Warning, TEXT("GGTWeaponSwitchTest: the player carries one weapon, only the alt fires are tested"));
+
+	// Switch and alt fire in the same frame, the server has to alt fire with the weapon the client switched to
+	for (int32 i = 0; i < NumSwitches; i++)
+	{
+		Character->NextWeapon();
+		Character->AltFireWeapon();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("GGTWeaponSwitchTest: %s, %d switches sent, waiting for the server"), Pickup ? TEXT("picked up a weapon") : TEXT("no weapon to pick up"), NumSwitches);
+
+	WeaponSwitchTestDeadline = GetWorld()->GetRealTimeSeconds() + 10.0f;
+	GetWorld()->GetTimerManager().SetTimer(WeaponSwitchTestTimer, this, &UGGTCheatManager::CheckWeaponSwitchTest, 0.1f, true);
+}
+
+void UGGTCheatManager::CheckWeaponSwitchTest()
+{
+	APlayerController* Controller = GetOuterAPlayerController();
+	AGGTCharacter* Character = Controller ? Cast<AGGTCharacter>(Controller->GetPawn()) : nullptr;
+	if (Character == nullptr)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(WeaponSwitchTestTimer);
+		return;
+	}
+
+	const FGGTPredictionStats& Stats = Character->GetPredictionStats();
+	const bool bAllAnswered = Stats.Acks >= Stats.Actions;
+	if (!bAllAnswered && GetWorld()->GetRealTimeSeconds() < WeaponSwitchTestDeadline)
+		return;
+
+	GetWorld()->GetTimerManager().ClearTimer(WeaponSwitchTestTimer);
+
+	UE_LOG(LogTemp, Log, TEXT("GGTWeaponSwitchTest: %d actions, %d answered, %d done with another weapon on the server, %d weapon slot corrections, %d held object corrections"),
+		Stats.Actions, Stats.Acks, Stats.WeaponMismatches, Stats.WeaponCorrections, Stats.Corrections);
+
+	if (!bAllAnswered)
+		UE_LOG(LogTemp, Error, TEXT("GGTWeaponSwitchTest: FAILED, the server didn't answer %d actions"), Stats.Actions - Stats.Acks);
+	else if (Stats.WeaponMismatches > 0)
+		UE_LOG(LogTemp, Error, TEXT("GGTWeaponSwitchTest: FAILED, the server used another weapon than the client for %d actions"), Stats.WeaponMismatches);
+	else
+		UE_LOG(LogTemp, Log, TEXT("GGTWeaponSwitchTest: PASSED"));
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/CheatManager.h"
+#include "GGTCheatManager.generated.h"
+
+/**
+ * Development console commands for measuring the weapon systems.
+ */
+UCLASS()
+class GRAVITYGUNTEST_API UGGTCheatManager : public UCheatManager
+{
+	GENERATED_BODY()
+	
+	public:
+
+		/** Test of the rewind buffer through a real connection, run it on a remote client, for example with GGTNetSim lag.
+		*	The client traces at moving props as it renders them and sends the traces to the server like a fire.
+		*	The server traces them against the current world and against the rewound props, and both sides log
+		*	how many traces hit the prop the client aimed at and the CPU cost of a rewind trace.
+		*/
+		UFUNCTION(Exec)
+		void GGTRewindTest(int32 NumTraces = 100);
+
+		/** Memory report of the weapons, characters and props in the world, in the style of obj list.
+		*	Logs the instance count, the size of the objects, what their arrays allocate and the same for the components they own.
+		*/
+		UFUNCTION(Exec)
+		void GGTMemReport();
+
+		/** Spawns free weapons of the class the player is holding in a grid in front of the player, to measure the memory of dropped weapons with GGTMemReport */
+		UFUNCTION(Exec)
+		void GGTSpawnDroppedWeapons(int32 Count = 10000, float Spacing = 100.0f);
+
+		/** Spawns copies of a prop in the level in a grid in front of the player, to measure prop replication with GGTNetReport */
+		UFUNCTION(Exec)
+		void GGTSpawnProps(int32 Count = 1000, float Spacing = 150.0f);
+
+		/** Report of the prop replication since the last report.
+		*	Logs how many props are dormant and active, the bytes sent per client per second,
+		*	and the server time spent on prop relevancy, dormancy and the net driver flush. Only works on the server.
+		*/
+		UFUNCTION(Exec)
+		void GGTNetReport();
+
+		/** Simulates a bad connection on this machine, for testing the prediction of weapon actions over loopback.
+		*	Sets the packet lag and loss of the net driver, 0 turns them off. Needs a build with network testing enabled.
+		*/
+		UFUNCTION(Exec)
+		void GGTNetSim(int32 LagMs = 100, int32 LossPercent = 5);
+
+		/** Report of the predicted weapon actions of the player since the last report.
+		*	Logs how many actions were predicted and answered, the round trip, and how many fires were refused or had the held object corrected.
+		*/
+		UFUNCTION(Exec)
+		void GGTPredictionReport();
+
+		/** Test of weapon changes followed by weapon actions on a remote client, for example with GGTNetSim lag.
+		*	Picks up the free weapon in front of the player if there is one and fires, then switches weapons and alt fires
+		*	in the same frame NumSwitches times. Once the server has answered everything it logs if the server used the same weapon
+		*	as the client for every action the client guessed.
+		*/
+		UFUNCTION(Exec)
+		void GGTWeaponSwitchTest(int32 NumSwitches = 10);
+
+
+	protected:
+
+		/** Polls for the answers of the server to GGTWeaponSwitchTest, and gives up at the deadline */
+		FTimerHandle WeaponSwitchTestTimer;
+		float WeaponSwitchTestDeadline;
+		void CheckWeaponSwitchTest();
+	
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTEffectScheduler.h"
+
+
+UGGTEffectScheduler::UGGTEffectScheduler()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// Only ticks while something is scheduled
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UGGTEffectScheduler::ScheduleDeactivation(UParticleSystemComponent* Component, float Delay)
+{
+	if (Component == nullptr)
+		return;
+
+	FPendingDeactivation Entry;
+	Entry.Time = GetWorld()->GetTimeSeconds() + Delay;
+	Entry.Component = Component;
+
+	DeactivateTimes.Add(Entry.Component, Entry.Time);
+	Heap.HeapPush(Entry);
+
+	SetComponentTickEnabled(true);
+}
+
+void UGGTEffectScheduler::CancelDeactivation(UParticleSystemComponent* Component)
+{
+	// The heap entry stays until it's due and is skipped then
+	DeactivateTimes.Remove(Component);
+}
+
+void UGGTEffectScheduler::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+	while (Heap.Num() > 0 && Heap.HeapTop().Time <= CurrentTime)
+	{
+		FPendingDeactivation Entry;
+		Heap.HeapPop(Entry, false);
+
+		// Skip entries that were replaced by a later deactivation or cancelled
+		const float* CurrentDeactivateTime = DeactivateTimes.Find(Entry.Component);
+		if (CurrentDeactivateTime == nullptr || *CurrentDeactivateTime != Entry.Time)
+			continue;
+
+		DeactivateTimes.Remove(Entry.Component);
+
+		UParticleSystemComponent* Component = Entry.Component.Get();
+		if (Component && !Component->IsPendingKill())
+			Component->DeactivateSystem();
+	}
+
+	// Every scheduled component has an entry in the heap, so nothing is left to do when it's empty
+	if (Heap.Num() == 0)
+		SetComponentTickEnabled(false);
+}
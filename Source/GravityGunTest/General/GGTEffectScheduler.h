@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTEffectScheduler.generated.h"
+
+
+/**
+ * Deactivates particle effects after a delay, for every weapon in the world.
+ * The pending deactivations are kept in a min-heap on their time, so a frame only looks at the ones that are due,
+ * and the component stops ticking when there are none. Scheduling the same component again replaces its earlier deactivation.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTEffectScheduler : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTEffectScheduler();
+
+		/** Deactivates the component after the delay, replaces any earlier scheduled deactivation of it */
+		void ScheduleDeactivation(UParticleSystemComponent* Component, float Delay);
+
+		/** Cancels the scheduled deactivation of the component, if there is one */
+		void CancelDeactivation(UParticleSystemComponent* Component);
+
+		/** How many deactivations are waiting */
+		int32 GetPendingCount() const { return DeactivateTimes.Num(); }
+
+		/** Called every frame while there are pending deactivations */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+	private:
+
+		struct FPendingDeactivation
+		{
+			float Time;
+			TWeakObjectPtr<UParticleSystemComponent> Component;
+
+			/** Orders the heap with the earliest time on top */
+			bool operator<(const FPendingDeactivation& Other) const { return Time < Other.Time; }
+		};
+
+		/** Every scheduled deactivation, including ones that were replaced or cancelled */
+		TArray<FPendingDeactivation> Heap;
+
+		/** The current deactivation time of every scheduled component. Heap entries with another time are stale and skipped. */
+		TMap<TWeakObjectPtr<UParticleSystemComponent>, float> DeactivateTimes;
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTFixedStepClock.h"
+
+
+UGGTFixedStepClock::UGGTFixedStepClock()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// The gameplay steps have to be done before the physics of the frame
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	FixedStepRate = 60.0f;
+	DedicatedServerStepRate = 0.0f;
+	MaxStepsPerFrame = 5;
+
+	StepTime = 1.0f / FixedStepRate;
+	Accumulator = 0.0f;
+	StepCount = 0;
+}
+
+void UGGTFixedStepClock::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Dedicated servers can simulate at a lower rate
+	if (IsRunningDedicatedServer() && DedicatedServerStepRate > 0.0f)
+		SetStepRate(DedicatedServerStepRate);
+	else
+		SetStepRate(FixedStepRate);
+}
+
+void UGGTFixedStepClock::SetStepRate(float NewStepRate)
+{
+	// Keep the interpolation alpha the same with the new step length
+	const float Alpha = GetInterpolationAlpha();
+
+	StepTime = 1.0f / FMath::Max(NewStepRate, 1.0f);
+	Accumulator = Alpha * StepTime;
+}
+
+void UGGTFixedStepClock::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	Accumulator += DeltaTime;
+
+	int32 Steps = 0;
+	while (Accumulator >= StepTime && Steps < MaxStepsPerFrame)
+	{
+		Accumulator -= StepTime;
+		Steps++;
+		StepCount++;
+
+		OnFixedStep.Broadcast(StepTime);
+	}
+
+	// Drop the time that didn't fit in this frame
+	if (Accumulator >= StepTime)
+		Accumulator = FMath::Fmod(Accumulator, StepTime);
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTFixedStepClock.generated.h"
+
+
+/** Called once for every fixed gameplay step, with the length of the step in seconds */
+DECLARE_MULTICAST_DELEGATE_OneParam(FGGTFixedStepDelegate, float);
+
+
+/**
+ * Gameplay clock that runs weapon and interaction logic at a fixed rate, no matter the frame rate.
+ * The frame time is collected in an accumulator and as many fixed steps as fit in it are run at the start of the frame.
+ * What is left over is exposed as an interpolation alpha so visuals can blend between the last two steps.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTFixedStepClock : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTFixedStepClock();
+
+		/** How many gameplay steps are run every second */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fixed Step", meta = (ClampMin = "1.0"))
+		float FixedStepRate;
+
+		/** The step rate used on dedicated servers, 0 uses FixedStepRate.
+		*	A lower rate uses less CPU per simulated second, but some gameplay depends on the rate:
+		*	the fire cooldown only counts down on steps, so it ends up to one step late,
+		*	the hold target and the tractor path are only updated on steps, so held and pulled objects follow the muzzle more coarsely,
+		*	and the trajectory prediction is only rechecked on steps.
+		*	The tractor force and the physics handle are applied every frame, so the pull strength doesn't depend on the rate.
+		*/
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fixed Step", meta = (ClampMin = "0.0"))
+		float DedicatedServerStepRate;
+
+		/** The most steps that are run in one frame. Time beyond this is dropped so a long hitch can't cause more hitches. */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fixed Step", meta = (ClampMin = "1"))
+		int32 MaxStepsPerFrame;
+
+
+		/** Bind to run logic on every fixed step */
+		FGGTFixedStepDelegate OnFixedStep;
+
+		/** Changes the step rate while playing */
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step")
+		void SetStepRate(float NewStepRate);
+
+		/** Get the length of a step in seconds */
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step")
+		float GetStepTime() const { return StepTime; }
+
+		/** Get how far between the last step and the next step the current frame is, from 0 to 1 */
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step")
+		float GetInterpolationAlpha() const { return Accumulator / StepTime; }
+
+		/** Get how many steps have been run since the game started */
+		uint32 GetStepCount() const { return StepCount; }
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+
+		/** Called every frame */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+	private:
+
+		float StepTime;
+		float Accumulator;
+		uint32 StepCount;
+};
@@ -3,9 +3,22 @@
 #include "GravityGunTest.h"
 #include "GGTGameMode.h"
 
+#include "GGTGameState.h"
+#include "GGTSoakTest.h"
+
 AGGTGameMode::AGGTGameMode()
 {
+	// Use the game state that owns the world level weapon systems
+	GameStateClass = AGGTGameState::StaticClass();
+}
+
+void AGGTGameMode::StartPlay()
+{
+	Super::StartPlay();
 
+	// Unattended test run with bots, see AGGTSoakTest
+	if (FParse::Param(FCommandLine::Get(), TEXT("ggtsoak")))
+		GetWorld()->SpawnActor<AGGTSoakTest>();
 }
 
 
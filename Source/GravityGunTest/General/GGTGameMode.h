@@ -17,6 +17,8 @@ class GRAVITYGUNTEST_API AGGTGameMode : public AGameModeBase
 
 		/** Set the default values */
 		AGGTGameMode();
-	
+
+		/** Starts the match, and the soak test when the server is started with -ggtsoak */
+		virtual void StartPlay() override;
 	
 };
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTGameState.h"
+
+#include "GGTQueryScheduler.h"
+#include "GGTRewindBuffer.h"
+#include "GGTImpactQueue.h"
+#include "GGTPullPathCache.h"
+#include "GGTFixedStepClock.h"
+#include "GGTTelemetry.h"
+#include "GGTEffectScheduler.h"
+#include "GGTPropReplication.h"
+
+AGGTGameState::AGGTGameState()
+{
+	// Create the world level systems
+	QueryScheduler = CreateDefaultSubobject<UGGTQueryScheduler>(TEXT("QueryScheduler"));
+	RewindBuffer = CreateDefaultSubobject<UGGTRewindBuffer>(TEXT("RewindBuffer"));
+	ImpactQueue = CreateDefaultSubobject<UGGTImpactQueue>(TEXT("ImpactQueue"));
+	PullPathCache = CreateDefaultSubobject<UGGTPullPathCache>(TEXT("PullPathCache"));
+	FixedStepClock = CreateDefaultSubobject<UGGTFixedStepClock>(TEXT("FixedStepClock"));
+	Telemetry = CreateDefaultSubobject<UGGTTelemetry>(TEXT("Telemetry"));
+	EffectScheduler = CreateDefaultSubobject<UGGTEffectScheduler>(TEXT("EffectScheduler"));
+	PropReplication = CreateDefaultSubobject<UGGTPropReplication>(TEXT("PropReplication"));
+}
+
+AGGTGameState* AGGTGameState::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr)
+		return nullptr;
+
+	return World->GetGameState<AGGTGameState>();
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/GameStateBase.h"
+#include "Engine/StreamableManager.h"
+#include "GGTGameState.generated.h"
+
+
+class UGGTQueryScheduler;
+class UGGTRewindBuffer;
+class UGGTImpactQueue;
+class UGGTPullPathCache;
+class UGGTFixedStepClock;
+class UGGTTelemetry;
+class UGGTEffectScheduler;
+class UGGTPropReplication;
+
+
+/**
+ * Game state that owns the world level systems shared between every weapon and character.
+ * The systems are components so that they tick once per world instead of once per weapon.
+ */
+UCLASS()
+class GRAVITYGUNTEST_API AGGTGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+	
+	public:
+
+		/** Set the default values */
+		AGGTGameState();
+
+		/** Spreads scene queries from every weapon over frames so that the total amount per frame is bounded */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTQueryScheduler* QueryScheduler;
+
+		/** Server side transform history of the props, used to validate the traces of remote clients */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTRewindBuffer* RewindBuffer;
+
+		/** Turns prop impacts into damage and fractures with a fixed amount of work per frame */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTImpactQueue* ImpactQueue;
+
+		/** Obstacle aware paths for objects pulled by gravity guns, shared between the guns pulling the same object */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTPullPathCache* PullPathCache;
+
+		/** Runs weapon and interaction logic at a fixed rate, independent of the frame rate */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTFixedStepClock* FixedStepClock;
+
+		/** Records gameplay events to a local file for tuning, off unless turned on */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTTelemetry* Telemetry;
+
+		/** Deactivates the timed weapon effects of every weapon from one heap, instead of a timer per weapon */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTEffectScheduler* EffectScheduler;
+
+		/** Decides which props are replicated to which clients, and puts the props at rest to sleep on the network */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Systems")
+		UGGTPropReplication* PropReplication;
+
+
+		/** Loads assets in the background for every weapon, see AWeaponBase::PrefetchAssets */
+		FStreamableManager StreamableManager;
+
+
+		/** Get the game state of the world the object is in, returns nullptr if the world is not using this game state */
+		static AGGTGameState* Get(const UObject* WorldContextObject);
+	
+};
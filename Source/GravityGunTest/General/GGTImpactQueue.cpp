@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTImpactQueue.h"
+
+#include "Props/GGTProp.h"
+
+
+UGGTImpactQueue::UGGTImpactQueue()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// Run after the physics has dispatched the hit events of the frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	MaxFracturesPerFrame = 4;
+}
+
+void UGGTImpactQueue::AddImpact(AGGTProp* Prop)
+{
+	PendingImpacts.Add(Prop);
+}
+
+void UGGTImpactQueue::AddFracture(AGGTProp* Prop)
+{
+	FractureQueue.AddUnique(Prop);
+}
+
+void UGGTImpactQueue::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Apply one damage event per prop that was hit, using the strongest impulse of the frame
+	for (const TWeakObjectPtr<AGGTProp>& Prop : PendingImpacts)
+	{
+		if (Prop.IsValid())
+			Prop->ApplyPendingImpact();
+	}
+	PendingImpacts.Reset();
+
+	// Only spawn a limited amount of fractures, the rest stays in the queue
+	int32 Processed = 0;
+	while (Processed < FractureQueue.Num() && Processed < MaxFracturesPerFrame)
+	{
+		AGGTProp* Prop = FractureQueue[Processed].Get();
+		if (Prop && !Prop->IsPendingKill())
+			Prop->Fracture();
+
+		Processed++;
+	}
+
+	if (Processed > 0)
+		FractureQueue.RemoveAt(0, Processed, false);
+}
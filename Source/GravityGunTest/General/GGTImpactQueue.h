@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTImpactQueue.generated.h"
+
+
+class AGGTProp;
+
+
+/**
+ * Collects the impacts of props and turns them into damage and fractures once per frame.
+ * Props only report their first hit of a frame, the strongest impulse is kept on the prop, so a pile of props being hit
+ * costs one damage event per body. Fractures spawn actors, so they are queued and only a few are processed every frame.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTImpactQueue : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTImpactQueue();
+
+		/** How many props may fracture every frame, the rest wait for the next frames */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Impact Queue", meta = (ClampMin = "1"))
+		int32 MaxFracturesPerFrame;
+
+
+		/** Adds a prop that was hit this frame, called by the prop on its first hit of the frame */
+		void AddImpact(AGGTProp* Prop);
+
+		/** Adds a prop that should be replaced by its fractured version */
+		void AddFracture(AGGTProp* Prop);
+
+		/** How many fractures are waiting to be processed */
+		int32 GetPendingFractureCount() const { return FractureQueue.Num(); }
+
+		/** Called every frame */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+	private:
+
+		/** Props that were hit this frame */
+		TArray<TWeakObjectPtr<AGGTProp>> PendingImpacts;
+
+		/** Props waiting to fracture, oldest first */
+		TArray<TWeakObjectPtr<AGGTProp>> FractureQueue;
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTImpulseProfileSet.h"
+
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+
+UGGTImpulseProfileSet::UGGTImpulseProfileSet()
+{
+	bLookupBuilt = false;
+}
+
+bool UGGTImpulseProfileSet::Resolve(const UPrimitiveComponent* Component, FGGTImpulseDescriptor& OutDescriptor) const
+{
+	if (Component == nullptr)
+		return false;
+
+	if (!bLookupBuilt)
+		BuildLookup();
+
+	const float Mass = Component->GetMass();
+
+	// Use the profiles of the material first, and the ones without a material if none of them fit
+	int32 ProfileIndex = INDEX_NONE;
+
+	const FBodyInstance* BodyInstance = Component->GetBodyInstance();
+	const UPhysicalMaterial* Material = BodyInstance ? BodyInstance->GetSimplePhysicalMaterial() : nullptr;
+
+	if (const TArray<int32>* MaterialProfiles = Lookup.Find(Material))
+		ProfileIndex = FindMassClass(*MaterialProfiles, Mass);
+
+	if (ProfileIndex == INDEX_NONE && Material != nullptr)
+	{
+		if (const TArray<int32>* DefaultProfiles = Lookup.Find(nullptr))
+			ProfileIndex = FindMassClass(*DefaultProfiles, Mass);
+	}
+
+	if (ProfileIndex == INDEX_NONE)
+		return false;
+
+	const FGGTImpulseProfile& Profile = Profiles[ProfileIndex];
+
+	const float Speed = Profile.LaunchSpeedByMass ? Profile.LaunchSpeedByMass->GetFloatValue(Mass) : Profile.LaunchSpeed;
+	OutDescriptor.LaunchSpeed = FMath::Clamp(Speed, 0.0f, Profile.MaxLaunchSpeed);
+	OutDescriptor.SpinSpeed = Profile.SpinSpeed;
+	return true;
+}
+
+void UGGTImpulseProfileSet::BuildLookup() const
+{
+	Lookup.Reset();
+
+	for (int32 i = 0; i < Profiles.Num(); i++)
+		Lookup.FindOrAdd(Profiles[i].PhysicalMaterial).Add(i);
+
+	// Smallest mass class first, so the first one the mass fits in is the tightest
+	for (auto& Pair : Lookup)
+	{
+		Pair.Value.Sort([this](int32 A, int32 B)
+		{
+			const float LimitA = Profiles[A].MaxMass > 0.0f ? Profiles[A].MaxMass : MAX_flt;
+			const float LimitB = Profiles[B].MaxMass > 0.0f ? Profiles[B].MaxMass : MAX_flt;
+			return LimitA < LimitB;
+		});
+	}
+
+	bLookupBuilt = true;
+}
+
+int32 UGGTImpulseProfileSet::FindMassClass(const TArray<int32>& Indices, float Mass) const
+{
+	for (int32 Index : Indices)
+	{
+		if (Profiles[Index].MaxMass <= 0.0f || Mass <= Profiles[Index].MaxMass)
+			return Index;
+	}
+
+	return INDEX_NONE;
+}
+
+#if WITH_EDITOR
+void UGGTImpulseProfileSet::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bLookupBuilt = false;
+}
+#endif
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "GGTImpulseProfileSet.generated.h"
+
+
+class UCurveFloat;
+class UPhysicalMaterial;
+
+
+/** How objects of one physical material and mass class react to being fired */
+USTRUCT(BlueprintType)
+struct FGGTImpulseProfile
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The physical material the profile is for, empty for objects that have no profile for their material */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse")
+	UPhysicalMaterial* PhysicalMaterial;
+
+	/** The heaviest object the profile is for, in kg. 0 has no limit.
+	*	The profile with the smallest limit the mass fits under is used, so the limits split the objects in mass classes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse", meta = (ClampMin = "0.0"))
+	float MaxMass;
+
+	/** The speed objects leave the gun with, in cm/s. Only used if there is no curve. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse", meta = (ClampMin = "0.0"))
+	float LaunchSpeed;
+
+	/** The launch speed by the mass of the object in kg, so heavier objects can leave slower */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse")
+	UCurveFloat* LaunchSpeedByMass;
+
+	/** The fastest an object can leave the gun, in cm/s */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse", meta = (ClampMin = "0.0"))
+	float MaxLaunchSpeed;
+
+	/** How fast the object tumbles forward after the launch, in degrees per second */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse")
+	float SpinSpeed;
+
+	FGGTImpulseProfile()
+		: PhysicalMaterial(nullptr)
+		, MaxMass(0.0f)
+		, LaunchSpeed(10000.0f)
+		, LaunchSpeedByMass(nullptr)
+		, MaxLaunchSpeed(10000.0f)
+		, SpinSpeed(0.0f)
+	{
+	}
+};
+
+
+/** What a shot does to one object, resolved from the profiles once and then cached */
+struct FGGTImpulseDescriptor
+{
+	/** The velocity change of the launch, in cm/s */
+	float LaunchSpeed;
+
+	/** The angular velocity after the launch, in degrees per second */
+	float SpinSpeed;
+
+	FGGTImpulseDescriptor()
+		: LaunchSpeed(0.0f)
+		, SpinSpeed(0.0f)
+	{
+	}
+};
+
+
+/**
+ * The impulse profiles of a gravity gun, by physical material and mass class.
+ * The profiles are grouped by material the first time they are used, after that resolving an object is a map lookup
+ * and a walk over the few mass classes of its material.
+ */
+UCLASS(BlueprintType)
+class GRAVITYGUNTEST_API UGGTImpulseProfileSet : public UDataAsset
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTImpulseProfileSet();
+
+		/** The profiles, in any order */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impulse")
+		TArray<FGGTImpulseProfile> Profiles;
+
+		/** Resolves the descriptor of the provided object. Returns false if no profile matches it. */
+		bool Resolve(const UPrimitiveComponent* Component, FGGTImpulseDescriptor& OutDescriptor) const;
+
+#if WITH_EDITOR
+		/** Rebuilds the lookup when the profiles are edited */
+		virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+
+	private:
+
+		/** Profile indices by material, sorted by mass limit with the unlimited ones last. Built on the first resolve. */
+		mutable TMap<const UPhysicalMaterial*, TArray<int32>> Lookup;
+		mutable bool bLookupBuilt;
+
+		void BuildLookup() const;
+
+		/** The first profile in the list the mass fits in, INDEX_NONE if there is none */
+		int32 FindMassClass(const TArray<int32>& Indices, float Mass) const;
+};
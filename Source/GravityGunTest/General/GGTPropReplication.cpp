@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTPropReplication.h"
+
+#include "Props/GGTProp.h"
+
+
+UGGTPropReplication::UGGTPropReplication()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	CellSize = 2500.0f;
+	RelevantCellRadius = 2;
+	ActiveRelevantCellRadius = 4;
+	ActivePriorityScale = 4.0f;
+	InFlightSpeed = 100.0f;
+	RefreshInterval = 0.1f;
+	WakeChecksPerTick = 256;
+
+	NextWakeCheck = 0;
+	LastRefreshTime = -BIG_NUMBER;
+
+	RelevancyChecks = 0;
+	RelevancyCycles = 0;
+	DormancyCycles = 0;
+	NetFlushCycles = 0;
+	NetFlushStartCycles = 0;
+	StatsStartTime = 0.0;
+}
+
+void UGGTPropReplication::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only the server decides what is replicated
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	// Broadcasts go through the handlers in the reverse order they were added in, the net driver added its handler
+	// when the world started listening, so this one runs right before it and the post flush right after it
+	TickFlushHandle = GetWorld()->TickFlushEvent.AddUObject(this, &UGGTPropReplication::OnTickFlush);
+	PostTickFlushHandle = GetWorld()->PostTickFlushEvent.AddUObject(this, &UGGTPropReplication::OnPostTickFlush);
+
+	StatsStartTime = FPlatformTime::Seconds();
+}
+
+void UGGTPropReplication::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorld()->TickFlushEvent.Remove(TickFlushHandle);
+	GetWorld()->PostTickFlushEvent.Remove(PostTickFlushHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGGTPropReplication::RegisterProp(AGGTProp* Prop)
+{
+	if (Prop == nullptr || Prop->NetListIndex != INDEX_NONE)
+		return;
+
+	// Start awake, the next refresh puts the prop to sleep if it's at rest
+	Prop->NetCell = GetCell(Prop->GetActorLocation());
+	Prop->bNetActive = false;
+	AddToList(Prop, false);
+}
+
+void UGGTPropReplication::UnregisterProp(AGGTProp* Prop)
+{
+	if (Prop == nullptr || Prop->NetListIndex == INDEX_NONE)
+		return;
+
+	RemoveFromList(Prop);
+}
+
+void UGGTPropReplication::WakeProp(AGGTProp* Prop)
+{
+	if (Prop == nullptr || Prop->NetListIndex == INDEX_NONE)
+		return;
+
+	// Gameplay is about to move the prop, so treat it as flying until the next refresh says otherwise
+	Prop->bNetActive = true;
+
+	if (!Prop->bNetDormant)
+		return;
+
+	RemoveFromList(Prop);
+	AddToList(Prop, false);
+
+	Prop->SetNetDormancy(DORM_Awake);
+	Prop->ForceNetUpdate();
+}
+
+bool UGGTPropReplication::IsRelevant(const AGGTProp* Prop, const FVector& ViewLocation) const
+{
+#if GGT_TIME_PROP_RELEVANCY
+	const uint32 StartCycles = FPlatformTime::Cycles();
+#endif
+
+	RelevancyChecks++;
+
+	// The cell of the prop is cached, so this is a few integer compares per prop and viewer
+	const FIntVector ViewCell = GetCell(ViewLocation);
+	const int32 Radius = Prop->bNetActive ? ActiveRelevantCellRadius : RelevantCellRadius;
+	const bool bRelevant = FMath::Abs(ViewCell.X - Prop->NetCell.X) <= Radius && FMath::Abs(ViewCell.Y - Prop->NetCell.Y) <= Radius;
+
+#if GGT_TIME_PROP_RELEVANCY
+	RelevancyCycles += FPlatformTime::Cycles() - StartCycles;
+#endif
+
+	return bRelevant;
+}
+
+FIntVector UGGTPropReplication::GetCell(const FVector& Location) const
+{
+	// Columns, the height doesn't matter for relevancy
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), 0);
+}
+
+void UGGTPropReplication::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	// Wake the dormant props that something else than a gun knocked over, a few every tick
+	const int32 NumChecks = FMath::Min(WakeChecksPerTick, DormantProps.Num());
+	for (int32 i = 0; i < NumChecks; i++)
+	{
+		if (NextWakeCheck >= DormantProps.Num())
+			NextWakeCheck = 0;
+
+		// Waking moves the last dormant prop into this index, so it's checked next
+		AGGTProp* Prop = DormantProps[NextWakeCheck];
+		if (Prop->PropMesh->RigidBodyIsAwake())
+			WakeProp(Prop);
+		else
+			NextWakeCheck++;
+	}
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	if (CurrentTime - LastRefreshTime >= RefreshInterval)
+	{
+		LastRefreshTime = CurrentTime;
+
+		// Backwards, a prop going dormant moves the last awake prop into its index and that one has been refreshed already
+		for (int32 i = AwakeProps.Num() - 1; i >= 0; i--)
+		{
+			AGGTProp* Prop = AwakeProps[i];
+			UPrimitiveComponent* Mesh = Prop->PropMesh;
+
+			const bool bHeld = Prop->HeldCount > 0;
+			Prop->NetCell = GetCell(Prop->GetActorLocation());
+			Prop->bNetActive = bHeld || Mesh->GetPhysicsLinearVelocity().SizeSquared() > FMath::Square(InFlightSpeed);
+
+			if (bHeld || Mesh->RigidBodyIsAwake())
+				continue;
+
+			// The prop is at rest, send where it stopped and then stop considering it until something moves it
+			RemoveFromList(Prop);
+			AddToList(Prop, true);
+
+			Prop->bNetActive = false;
+			Prop->ForceNetUpdate();
+			Prop->SetNetDormancy(DORM_DormantAll);
+		}
+	}
+
+	DormancyCycles += FPlatformTime::Cycles() - StartCycles;
+}
+
+void UGGTPropReplication::AddToList(AGGTProp* Prop, bool bDormant)
+{
+	TArray<AGGTProp*>& List = bDormant ? DormantProps : AwakeProps;
+
+	Prop->bNetDormant = bDormant;
+	Prop->NetListIndex = List.Add(Prop);
+}
+
+void UGGTPropReplication::RemoveFromList(AGGTProp* Prop)
+{
+	TArray<AGGTProp*>& List = Prop->bNetDormant ? DormantProps : AwakeProps;
+	const int32 Index = Prop->NetListIndex;
+
+	List.RemoveAtSwap(Index, 1, false);
+	if (List.IsValidIndex(Index))
+		List[Index]->NetListIndex = Index;
+
+	Prop->NetListIndex = INDEX_NONE;
+}
+
+FGGTPropNetStats UGGTPropReplication::TakeStats()
+{
+	const double CurrentTime = FPlatformTime::Seconds();
+
+	FGGTPropNetStats Stats;
+	Stats.Seconds = (float)(CurrentTime - StatsStartTime);
+	Stats.NumProps = AwakeProps.Num() + DormantProps.Num();
+	Stats.NumDormant = DormantProps.Num();
+
+	Stats.NumActive = 0;
+	for (const AGGTProp* Prop : AwakeProps)
+	{
+		if (Prop->bNetActive)
+			Stats.NumActive++;
+	}
+
+	Stats.NumClients = 0;
+	Stats.AveragePropBytesPerClient = 0.0f;
+	Stats.MaxPropBytesPerClient = 0.0f;
+	Stats.AverageBytesPerClient = 0.0f;
+	Stats.MaxBytesPerClient = 0;
+
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver)
+	{
+		const float SecondsScale = 1.0f / FMath::Max(Stats.Seconds, KINDA_SMALL_NUMBER);
+
+		int64 TotalPropBits = 0;
+		int64 TotalBytes = 0;
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection == nullptr)
+				continue;
+
+			Stats.NumClients++;
+
+			// What the props wrote for the connection since the last measurement
+			const int64 PropBits = PropBitsPerConnection.FindRef(Connection);
+			TotalPropBits += PropBits;
+			Stats.MaxPropBytesPerClient = FMath::Max(Stats.MaxPropBytesPerClient, (PropBits / 8) * SecondsScale);
+
+			// The connections count everything they sent over the last whole second
+			TotalBytes += Connection->OutBytesPerSecond;
+			Stats.MaxBytesPerClient = FMath::Max(Stats.MaxBytesPerClient, Connection->OutBytesPerSecond);
+		}
+
+		if (Stats.NumClients > 0)
+		{
+			Stats.AveragePropBytesPerClient = ((TotalPropBits / 8) * SecondsScale) / Stats.NumClients;
+			Stats.AverageBytesPerClient = (float)TotalBytes / Stats.NumClients;
+		}
+	}
+
+	const float MsToPerSecond = 1.0f / FMath::Max(Stats.Seconds, KINDA_SMALL_NUMBER);
+	Stats.RelevancyChecksPerSecond = RelevancyChecks * MsToPerSecond;
+	Stats.RelevancyMsPerSecond = FPlatformTime::ToMilliseconds(RelevancyCycles) * MsToPerSecond;
+	Stats.DormancyMsPerSecond = FPlatformTime::ToMilliseconds(DormancyCycles) * MsToPerSecond;
+	Stats.NetFlushMsPerSecond = FPlatformTime::ToMilliseconds(NetFlushCycles) * MsToPerSecond;
+
+	RelevancyChecks = 0;
+	RelevancyCycles = 0;
+	DormancyCycles = 0;
+	NetFlushCycles = 0;
+	PropBitsPerConnection.Reset();
+	StatsStartTime = CurrentTime;
+
+	return Stats;
+}
+
+void UGGTPropReplication::AddPropBits(UNetConnection* Connection, int64 NumBits)
+{
+	PropBitsPerConnection.FindOrAdd(Connection) += NumBits;
+}
+
+void UGGTPropReplication::OnTickFlush(float DeltaSeconds)
+{
+	NetFlushStartCycles = FPlatformTime::Cycles();
+}
+
+void UGGTPropReplication::OnPostTickFlush()
+{
+	NetFlushCycles += FPlatformTime::Cycles() - NetFlushStartCycles;
+}
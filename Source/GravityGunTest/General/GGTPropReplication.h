@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTPropReplication.generated.h"
+
+
+class AGGTProp;
+
+
+/** Set to 1 to time every prop relevancy check. Off by default, reading the timer costs about as much as the check it measures. */
+#ifndef GGT_TIME_PROP_RELEVANCY
+#define GGT_TIME_PROP_RELEVANCY 0
+#endif
+
+
+/** Replication measurements since the last time they were taken */
+struct FGGTPropNetStats
+{
+	/** Seconds the measurements cover */
+	float Seconds;
+
+	int32 NumProps;
+	int32 NumDormant;
+	int32 NumActive;
+
+	/** Connected clients, and the bytes of prop replication the server sent to them per second */
+	int32 NumClients;
+	float AveragePropBytesPerClient;
+	float MaxPropBytesPerClient;
+
+	/** Everything the server sent to the clients in the last second, including the other actors and the packet overhead */
+	float AverageBytesPerClient;
+	int32 MaxBytesPerClient;
+
+	/** How many times per second the net driver asked if a prop is relevant to a viewer */
+	float RelevancyChecksPerSecond;
+
+	/** Time the server spent per second deciding prop relevancy and dormancy, and in the net driver flush that replicates the actors.
+	*	The relevancy checks run inside the flush, they are only timed on their own when GGT_TIME_PROP_RELEVANCY is set.
+	*/
+	float RelevancyMsPerSecond;
+	float DormancyMsPerSecond;
+	float NetFlushMsPerSecond;
+};
+
+
+/**
+ * Server side interest management of the props.
+ * The world is split in a grid of columns, and a prop is only relevant to viewers within a few cells of the cell it's in.
+ * Held and flying props are relevant further away and get a priority boost, props at rest go dormant until something moves them,
+ * so the net driver only spends time on the props that can change.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTPropReplication : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTPropReplication();
+
+		/** The width of the grid cells */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "100.0"))
+		float CellSize;
+
+		/** How many cells away from the viewer a prop at rest is relevant */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "0"))
+		int32 RelevantCellRadius;
+
+		/** How many cells away from the viewer a held or flying prop is relevant */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "0"))
+		int32 ActiveRelevantCellRadius;
+
+		/** How much the net priority of held and flying props is raised */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "1.0"))
+		float ActivePriorityScale;
+
+		/** How fast a prop has to move to count as flying */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "0.0"))
+		float InFlightSpeed;
+
+		/** How often the cells of the awake props are updated and the ones at rest put to sleep */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "0.0"))
+		float RefreshInterval;
+
+		/** How many dormant props are checked every tick for being knocked awake by something else than a gun */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prop Replication", meta = (ClampMin = "0"))
+		int32 WakeChecksPerTick;
+
+
+		/** Starts managing the replication of the provided prop */
+		void RegisterProp(AGGTProp* Prop);
+
+		/** Stops managing the replication of the provided prop */
+		void UnregisterProp(AGGTProp* Prop);
+
+		/** Makes a dormant prop replicate again */
+		void WakeProp(AGGTProp* Prop);
+
+		/** If the prop is close enough to the viewer to be replicated to it */
+		bool IsRelevant(const AGGTProp* Prop, const FVector& ViewLocation) const;
+
+		/** Get the grid cell the location is in */
+		FIntVector GetCell(const FVector& Location) const;
+
+		/** Get the measurements since the last call and start new ones */
+		FGGTPropNetStats TakeStats();
+
+		/** Counts the bits a prop wrote for a connection when it was replicated */
+		void AddPropBits(UNetConnection* Connection, int64 NumBits);
+
+		/** Updates the cells of the props and their dormancy */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+
+		/** Called when the component is removed */
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+	private:
+
+		/** The registered props, the ones that replicate and the ones that are dormant */
+		UPROPERTY()
+		TArray<AGGTProp*> AwakeProps;
+		UPROPERTY()
+		TArray<AGGTProp*> DormantProps;
+
+		/** The dormant prop to check next for being awake */
+		int32 NextWakeCheck;
+
+		float LastRefreshTime;
+
+		/** Adds the prop to the end of the awake or dormant list */
+		void AddToList(AGGTProp* Prop, bool bDormant);
+
+		/** Removes the prop from the list it is in, the last prop of the list takes its place */
+		void RemoveFromList(AGGTProp* Prop);
+
+		/** The bits of prop replication written for each connection since the measurements were last taken.
+		*	The connections are only used as keys, the ones that are gone don't show up in the client connections anymore.
+		*/
+		TMap<UNetConnection*, int64> PropBitsPerConnection;
+
+		/** Relevancy checks and cycles spent since the measurements were last taken */
+		mutable uint32 RelevancyChecks;
+		mutable uint32 RelevancyCycles;
+		uint32 DormancyCycles;
+		uint32 NetFlushCycles;
+		uint32 NetFlushStartCycles;
+		double StatsStartTime;
+
+		/** Times the flush of the net driver, which is where the actors are replicated */
+		FDelegateHandle TickFlushHandle;
+		FDelegateHandle PostTickFlushHandle;
+		void OnTickFlush(float DeltaSeconds);
+		void OnPostTickFlush();
+};
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTPullPathCache.h"
+
+#include "GGTGameState.h"
+#include "Weapons/GravityGun.h"
+
+
+UGGTPullPathCache::UGGTPullPathCache()
+{
+	RefreshInterval = 0.2f;
+	GoalMoveThreshold = 100.0f;
+
+	NextPath = 0;
+}
+
+void UGGTPullPathCache::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Get the sweeps from the shared query budget
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->QueryScheduler)
+		GameState->QueryScheduler->RegisterClient(this);
+}
+
+void UGGTPullPathCache::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->QueryScheduler)
+		GameState->QueryScheduler->UnregisterClient(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UGGTPullPathCache::FPullPath* UGGTPullPathCache::FindPath(UPrimitiveComponent* Component)
+{
+	for (FPullPath& Path : Paths)
+	{
+		if (Path.Component.Get() == Component)
+			return &Path;
+	}
+
+	return nullptr;
+}
+
+void UGGTPullPathCache::AddPuller(UPrimitiveComponent* Component)
+{
+	if (Component == nullptr)
+		return;
+
+	FPullPath* Path = FindPath(Component);
+	if (Path)
+	{
+		Path->Pullers++;
+		return;
+	}
+
+	FPullPath NewPath;
+	NewPath.Component = Component;
+	NewPath.Pullers = 1;
+	NewPath.Radius = AGravityGun::GetLocalRadius(Component);
+	NewPath.Goal = Component->GetComponentLocation();
+	NewPath.SweptGoal = NewPath.Goal;
+	NewPath.SweepTime = -BIG_NUMBER;
+	NewPath.Detour = FVector::ZeroVector;
+	NewPath.bBlocked = false;
+	Paths.Add(NewPath);
+}
+
+void UGGTPullPathCache::RemovePuller(UPrimitiveComponent* Component)
+{
+	for (int32 i = 0; i < Paths.Num(); i++)
+	{
+		if (Paths[i].Component.Get() == Component && --Paths[i].Pullers <= 0)
+		{
+			Paths.RemoveAtSwap(i);
+			return;
+		}
+	}
+}
+
+FVector UGGTPullPathCache::GetNextWaypoint(UPrimitiveComponent* Component, const FVector& Goal)
+{
+	FPullPath* Path = FindPath(Component);
+	if (Path == nullptr)
+		return Goal;
+
+	Path->Goal = Goal;
+
+	// Go around the obstacle until the object has reached the detour point
+	if (Path->bBlocked && FVector::DistSquared(Component->GetComponentLocation(), Path->Detour) > FMath::Square(Path->Radius))
+		return Path->Detour;
+
+	return Goal;
+}
+
+int32 UGGTPullPathCache::RunScheduledQueries(int32 Budget)
+{
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+
+	int32 QueriesRun = 0;
+	int32 Visited = 0;
+
+	while (QueriesRun < Budget && Visited < Paths.Num())
+	{
+		if (NextPath >= Paths.Num())
+			NextPath = 0;
+
+		FPullPath& Path = Paths[NextPath];
+		NextPath++;
+		Visited++;
+
+		UPrimitiveComponent* Component = Path.Component.Get();
+		if (Component == nullptr)
+			continue;
+
+		// Only sweep paths that are stale
+		const bool bExpired = WorldTime - Path.SweepTime >= RefreshInterval;
+		const bool bGoalMoved = FVector::DistSquared(Path.Goal, Path.SweptGoal) > FMath::Square(GoalMoveThreshold);
+		if (!bExpired && !bGoalMoved)
+			continue;
+
+		Path.SweptGoal = Path.Goal;
+		Path.SweepTime = WorldTime;
+
+		// Sweep the bounds of the object toward the goal
+		const float Radius = Path.Radius;
+		const FVector Start = Component->GetComponentLocation();
+
+		FCollisionQueryParams SweepParams(FName(TEXT("Pull Path")), false, Component->GetOwner());
+		SweepParams.AddIgnoredComponent(Component);
+
+		FHitResult hitResult(ForceInit);
+		QueriesRun++;
+
+		Path.bBlocked = GetWorld()->SweepSingleByChannel(hitResult, Start, Path.Goal, FQuat::Identity, Component->GetCollisionObjectType(), FCollisionShape::MakeSphere(Radius), SweepParams, FCollisionResponseParams(Component->GetCollisionResponseToChannels()));
+
+		if (Path.bBlocked)
+		{
+			// Go up and away from the obstacle, the next sweep continues from wherever the object got to
+			Path.Detour = hitResult.Location + (hitResult.ImpactNormal * Radius) + (FVector::UpVector * Radius * 2.0f);
+		}
+	}
+
+	// Remove the paths of objects that were destroyed while being pulled
+	Paths.RemoveAllSwap([](const FPullPath& Path) { return !Path.Component.IsValid(); });
+
+	return QueriesRun;
+}
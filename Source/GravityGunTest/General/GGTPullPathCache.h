@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "General/GGTQueryScheduler.h"
+#include "GGTPullPathCache.generated.h"
+
+
+/**
+ * Obstacle aware paths for objects that are being pulled by gravity guns in tractor mode.
+ * There is one path per pulled object, shared by every gun pulling it, and the sweeps that keep the paths up to date
+ * are run through the query scheduler so their cost per frame is bounded.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTPullPathCache : public UActorComponent, public IGGTQueryClient
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTPullPathCache();
+
+		/** How often the path of a pulled object is swept again */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pull Path", meta = (ClampMin = "0.0"))
+		float RefreshInterval;
+
+		/** How far the goal has to move before the path is swept again, even if it was swept recently */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pull Path", meta = (ClampMin = "0.0"))
+		float GoalMoveThreshold;
+
+
+		/** Adds a gun pulling the provided object, the path is kept until every gun has stopped pulling */
+		void AddPuller(UPrimitiveComponent* Component);
+		void RemovePuller(UPrimitiveComponent* Component);
+
+		/** Get the point the object should move toward to reach the goal.
+		*	Until the path has been swept, or if it's clear, this is the goal itself.
+		*/
+		FVector GetNextWaypoint(UPrimitiveComponent* Component, const FVector& Goal);
+
+		/** Sweeps the stale paths, called by the query scheduler */
+		virtual int32 RunScheduledQueries(int32 Budget) override;
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+
+		/** Called when the component is removed */
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+	private:
+
+		struct FPullPath
+		{
+			TWeakObjectPtr<UPrimitiveComponent> Component;
+
+			/** How many guns are pulling the object */
+			int32 Pullers;
+
+			/** The local radius of the object, cached when the path is created like the hold radius of the gun */
+			float Radius;
+
+			/** The goal the path was requested for, the latest request wins when several guns pull the same object */
+			FVector Goal;
+
+			/** The goal and time of the last sweep */
+			FVector SweptGoal;
+			float SweepTime;
+
+			/** Detour point around the obstacle between the object and the goal, only valid if bBlocked */
+			FVector Detour;
+			bool bBlocked;
+		};
+
+		TArray<FPullPath> Paths;
+
+		/** Index of the path that is checked first on the next scheduled run */
+		int32 NextPath;
+
+		FPullPath* FindPath(UPrimitiveComponent* Component);
+};
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTQueryScheduler.h"
+
+
+UGGTQueryScheduler::UGGTQueryScheduler()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	MaxQueriesPerFrame = 8;
+	MaxQueriesPerClient = 2;
+
+	NextClient = 0;
+	QueriesLastFrame = 0;
+}
+
+void UGGTQueryScheduler::RegisterClient(UObject* Client)
+{
+	IGGTQueryClient* Interface = Cast<IGGTQueryClient>(Client);
+	if (Interface == nullptr)
+		return;
+
+	// Don't add the same client twice
+	for (const FQueryClientEntry& Entry : Clients)
+	{
+		if (Entry.Object.Get() == Client)
+			return;
+	}
+
+	FQueryClientEntry NewEntry;
+	NewEntry.Object = Client;
+	NewEntry.Interface = Interface;
+	Clients.Add(NewEntry);
+}
+
+void UGGTQueryScheduler::UnregisterClient(UObject* Client)
+{
+	for (int32 i = 0; i < Clients.Num(); i++)
+	{
+		if (Clients[i].Object.Get() == Client)
+		{
+			Clients.RemoveAt(i);
+
+			// Keep the round robin position pointing at the same client
+			if (NextClient > i)
+				NextClient--;
+
+			return;
+		}
+	}
+}
+
+void UGGTQueryScheduler::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	int32 Budget = MaxQueriesPerFrame;
+	int32 Visited = 0;
+	int32 ClientCount = Clients.Num();
+
+	// Serve the clients round robin, starting where the last frame stopped
+	while (Budget > 0 && Visited < ClientCount && Clients.Num() > 0)
+	{
+		if (NextClient >= Clients.Num())
+			NextClient = 0;
+
+		FQueryClientEntry& Entry = Clients[NextClient];
+		if (!Entry.Object.IsValid())
+		{
+			// The client was destroyed without unregistering
+			Clients.RemoveAt(NextClient);
+			ClientCount--;
+			continue;
+		}
+
+		Budget -= FMath::Clamp(Entry.Interface->RunScheduledQueries(FMath::Min(Budget, MaxQueriesPerClient)), 0, Budget);
+
+		NextClient++;
+		Visited++;
+	}
+
+	QueriesLastFrame = MaxQueriesPerFrame - Budget;
+}
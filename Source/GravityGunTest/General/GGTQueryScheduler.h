@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTQueryScheduler.generated.h"
+
+
+/** Interface for objects that want to run scene queries through the query scheduler */
+UINTERFACE()
+class GRAVITYGUNTEST_API UGGTQueryClient : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class GRAVITYGUNTEST_API IGGTQueryClient
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Run at most Budget scene queries, returns how many were actually run.
+		*	Return 0 when there is no pending work so that the budget goes to the next client.
+		*/
+		virtual int32 RunScheduledQueries(int32 Budget) = 0;
+};
+
+
+/**
+ * Hands out a fixed amount of scene queries every frame to the registered clients.
+ * Clients are served round robin so that no client starves, no matter how many guns are aiming at the same time.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTQueryScheduler : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTQueryScheduler();
+
+		/** How many scene queries all clients together may run every frame */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Query Scheduler")
+		int32 MaxQueriesPerFrame;
+
+		/** How many scene queries a single client may run every frame */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Query Scheduler")
+		int32 MaxQueriesPerClient;
+
+
+		/** Adds a client that will be given queries every frame, the object must implement IGGTQueryClient */
+		void RegisterClient(UObject* Client);
+
+		/** Removes a client, call this before the client is destroyed */
+		void UnregisterClient(UObject* Client);
+
+		/** How many queries were run during the last frame */
+		int32 GetQueriesLastFrame() const { return QueriesLastFrame; }
+
+		/** Called every frame */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+	private:
+
+		/** The registered clients and their interface, the weak pointer is used to skip clients that were destroyed */
+		struct FQueryClientEntry
+		{
+			TWeakObjectPtr<UObject> Object;
+			IGGTQueryClient* Interface;
+		};
+
+		TArray<FQueryClientEntry> Clients;
+
+		/** Index of the client that will be served first next frame */
+		int32 NextClient;
+
+		int32 QueriesLastFrame;
+};
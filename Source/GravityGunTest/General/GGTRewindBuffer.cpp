@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTRewindBuffer.h"
+
+
+UGGTRewindBuffer::UGGTRewindBuffer()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	MemoryBudgetKB = 1024;
+	MaxTrackedProps = 512;
+	MaxRewindTime = 0.5f;
+
+	SamplesPerProp = 0;
+	NewestSample = INDEX_NONE;
+	NumSamples = 0;
+	RecordInterval = 0.0f;
+	LastRecordTime = -BIG_NUMBER;
+}
+
+void UGGTRewindBuffer::AllocateHistory()
+{
+	if (SamplesPerProp > 0)
+		return;
+
+	// Split the budget evenly between the prop slots, every sample also needs its share of the time array
+	const int32 BudgetBytes = MemoryBudgetKB * 1024;
+	const int32 BytesPerSample = (MaxTrackedProps * sizeof(FRewindSample)) + sizeof(float);
+	SamplesPerProp = FMath::Max(BudgetBytes / BytesPerSample, 2);
+
+	Samples.SetNumUninitialized(MaxTrackedProps * SamplesPerProp);
+	SampleTimes.SetNumZeroed(SamplesPerProp);
+	TrackedProps.SetNum(MaxTrackedProps);
+
+	// Handles are given out from the front
+	FreeHandles.Reserve(MaxTrackedProps);
+	for (int32 i = MaxTrackedProps - 1; i >= 0; i--)
+	{
+		FreeHandles.Add(i);
+	}
+	ActiveHandles.Reserve(MaxTrackedProps);
+
+	// Spread the samples over the rewind window, the newest sample is always the last frame
+	RecordInterval = MaxRewindTime / (SamplesPerProp - 1);
+}
+
+int32 UGGTRewindBuffer::RegisterProp(UPrimitiveComponent* Component)
+{
+	if (Component == nullptr)
+		return INDEX_NONE;
+
+	AllocateHistory();
+
+	if (FreeHandles.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Rewind buffer is full, %s will not be lag compensated"), *Component->GetOwner()->GetName());
+		return INDEX_NONE;
+	}
+
+	const int32 Handle = FreeHandles.Pop(false);
+	ActiveHandles.Add(Handle);
+
+	FTrackedProp& Prop = TrackedProps[Handle];
+	Prop.Component = Component;
+
+	const FBoxSphereBounds LocalBounds = Component->CalcBounds(FTransform(FQuat::Identity, FVector::ZeroVector, Component->GetComponentScale()));
+	Prop.LocalBox = LocalBounds.GetBox();
+	Prop.Radius = LocalBounds.SphereRadius + LocalBounds.Origin.Size();
+
+	// Fill the whole history with the current transform, the slot still holds samples from the previous prop
+	FRewindSample Current;
+	Current.Location = Component->GetComponentLocation();
+	Current.Rotation = Component->GetComponentQuat();
+
+	for (int32 i = 0; i < SamplesPerProp; i++)
+	{
+		Samples[(Handle * SamplesPerProp) + i] = Current;
+	}
+
+	return Handle;
+}
+
+void UGGTRewindBuffer::UnregisterProp(int32 Handle)
+{
+	if (!TrackedProps.IsValidIndex(Handle) || ActiveHandles.RemoveSingleSwap(Handle, false) == 0)
+		return;
+
+	TrackedProps[Handle].Component.Reset();
+	FreeHandles.Add(Handle);
+}
+
+UPrimitiveComponent* UGGTRewindBuffer::GetTrackedComponent(int32 Handle) const
+{
+	return TrackedProps.IsValidIndex(Handle) ? TrackedProps[Handle].Component.Get() : nullptr;
+}
+
+int32 UGGTRewindBuffer::GetAllocatedBytes() const
+{
+	return Samples.GetAllocatedSize() + SampleTimes.GetAllocatedSize() + TrackedProps.GetAllocatedSize() + ActiveHandles.GetAllocatedSize() + FreeHandles.GetAllocatedSize();
+}
+
+void UGGTRewindBuffer::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Clients never validate traces
+	if (GetOwnerRole() != ROLE_Authority || ActiveHandles.Num() == 0)
+		return;
+
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	if (WorldTime - LastRecordTime >= RecordInterval)
+		RecordSamples(WorldTime);
+}
+
+void UGGTRewindBuffer::RecordSamples(float WorldTime)
+{
+	LastRecordTime = WorldTime;
+
+	// Move the ring buffer forward, overwriting the oldest sample
+	NewestSample = (NewestSample + 1) % SamplesPerProp;
+	NumSamples = FMath::Min(NumSamples + 1, SamplesPerProp);
+	SampleTimes[NewestSample] = WorldTime;
+
+	for (int32 Handle : ActiveHandles)
+	{
+		FRewindSample& Sample = Samples[(Handle * SamplesPerProp) + NewestSample];
+		UPrimitiveComponent* Component = TrackedProps[Handle].Component.Get();
+
+		if (Component)
+		{
+			Sample.Location = Component->GetComponentLocation();
+			Sample.Rotation = Component->GetComponentQuat();
+		}
+		else
+		{
+			// Keep the last known transform if the component is gone but not unregistered yet
+			Sample = Samples[(Handle * SamplesPerProp) + ((NewestSample + SamplesPerProp - 1) % SamplesPerProp)];
+		}
+	}
+}
+
+bool UGGTRewindBuffer::FindSamplePair(float WorldTime, int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+	if (NumSamples == 0)
+		return false;
+
+	// Never rewind further than the window, or into the future
+	const float NewestTime = SampleTimes[NewestSample];
+	WorldTime = FMath::Clamp(WorldTime, NewestTime - MaxRewindTime, NewestTime);
+
+	const int32 OldestSample = (NewestSample - NumSamples + 1 + SamplesPerProp) % SamplesPerProp;
+
+	// Binary search for the last sample that is not newer than the time, the samples are in time order starting from the oldest
+	int32 Low = 0;
+	int32 High = NumSamples - 1;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High + 1) / 2;
+		if (SampleTimes[(OldestSample + Mid) % SamplesPerProp] <= WorldTime)
+			Low = Mid;
+		else
+			High = Mid - 1;
+	}
+
+	OutOlder = (OldestSample + Low) % SamplesPerProp;
+	OutNewer = (Low < NumSamples - 1) ? (OldestSample + Low + 1) % SamplesPerProp : OutOlder;
+
+	const float OlderTime = SampleTimes[OutOlder];
+	const float NewerTime = SampleTimes[OutNewer];
+	OutAlpha = (NewerTime > OlderTime) ? FMath::Clamp((WorldTime - OlderTime) / (NewerTime - OlderTime), 0.0f, 1.0f) : 0.0f;
+
+	return true;
+}
+
+FTransform UGGTRewindBuffer::BlendSamples(int32 Handle, int32 Older, int32 Newer, float Alpha) const
+{
+	const FRewindSample& OlderSample = Samples[(Handle * SamplesPerProp) + Older];
+	const FRewindSample& NewerSample = Samples[(Handle * SamplesPerProp) + Newer];
+
+	return FTransform(FQuat::Slerp(OlderSample.Rotation, NewerSample.Rotation, Alpha), FMath::Lerp(OlderSample.Location, NewerSample.Location, Alpha));
+}
+
+bool UGGTRewindBuffer::GetPropTransformAtTime(int32 Handle, float WorldTime, FTransform& OutTransform) const
+{
+	int32 Older, Newer;
+	float Alpha;
+
+	if (!TrackedProps.IsValidIndex(Handle) || !TrackedProps[Handle].Component.IsValid() || !FindSamplePair(WorldTime, Older, Newer, Alpha))
+		return false;
+
+	OutTransform = BlendSamples(Handle, Older, Newer, Alpha);
+	return true;
+}
+
+bool UGGTRewindBuffer::RewindLineTrace(const FVector& Start, const FVector& End, float WorldTime, FGGTRewindHit& OutHit) const
+{
+	int32 Older, Newer;
+	float Alpha;
+
+	if (!FindSamplePair(WorldTime, Older, Newer, Alpha))
+		return false;
+
+	const FVector TraceDelta = End - Start;
+	const float TraceLength = TraceDelta.Size();
+	if (TraceLength < KINDA_SMALL_NUMBER)
+		return false;
+
+	const FVector TraceDirection = TraceDelta / TraceLength;
+
+	float ClosestDistance = TraceLength;
+	OutHit = FGGTRewindHit();
+
+	for (int32 Handle : ActiveHandles)
+	{
+		const FTrackedProp& Prop = TrackedProps[Handle];
+		UPrimitiveComponent* Component = Prop.Component.Get();
+		if (Component == nullptr)
+			continue;
+
+		// Cheap rejection with the bounding sphere before doing the rotation blend and box test
+		const FVector& OlderLocation = Samples[(Handle * SamplesPerProp) + Older].Location;
+		const FVector& NewerLocation = Samples[(Handle * SamplesPerProp) + Newer].Location;
+		const FVector Center = FMath::Lerp(OlderLocation, NewerLocation, Alpha);
+
+		const float AlongTrace = FVector::DotProduct(Center - Start, TraceDirection);
+		if (AlongTrace < -Prop.Radius || AlongTrace > ClosestDistance + Prop.Radius)
+			continue;
+
+		if (FVector::DistSquared(Start + (TraceDirection * FMath::Clamp(AlongTrace, 0.0f, TraceLength)), Center) > FMath::Square(Prop.Radius))
+			continue;
+
+		// Test the line against the rewound box in the local space of the prop, using the slab method
+		const FTransform PropTransform = BlendSamples(Handle, Older, Newer, Alpha);
+		const FVector LocalStart = PropTransform.InverseTransformPositionNoScale(Start);
+		const FVector LocalDirection = PropTransform.InverseTransformVectorNoScale(TraceDirection);
+
+		float EntryDistance = 0.0f;
+		float ExitDistance = ClosestDistance;
+		bool bMissed = false;
+
+		for (int32 Axis = 0; Axis < 3 && !bMissed; Axis++)
+		{
+			if (FMath::Abs(LocalDirection[Axis]) < KINDA_SMALL_NUMBER)
+			{
+				// Parallel to the slab, only a hit if the start is inside it
+				bMissed = LocalStart[Axis] < Prop.LocalBox.Min[Axis] || LocalStart[Axis] > Prop.LocalBox.Max[Axis];
+				continue;
+			}
+
+			float Near = (Prop.LocalBox.Min[Axis] - LocalStart[Axis]) / LocalDirection[Axis];
+			float Far = (Prop.LocalBox.Max[Axis] - LocalStart[Axis]) / LocalDirection[Axis];
+			if (Near > Far)
+				Swap(Near, Far);
+
+			EntryDistance = FMath::Max(EntryDistance, Near);
+			ExitDistance = FMath::Min(ExitDistance, Far);
+			bMissed = EntryDistance > ExitDistance;
+		}
+
+		if (bMissed)
+			continue;
+
+		ClosestDistance = EntryDistance;
+		OutHit.Component = Component;
+		OutHit.Distance = EntryDistance;
+		OutHit.Location = Start + (TraceDirection * EntryDistance);
+	}
+
+	return OutHit.Component != nullptr;
+}
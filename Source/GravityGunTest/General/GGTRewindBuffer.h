@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTRewindBuffer.generated.h"
+
+
+/** Result of a trace against the rewound props */
+struct FGGTRewindHit
+{
+	/** The prop component that was hit */
+	UPrimitiveComponent* Component;
+
+	/** Where the trace entered the rewound bounds of the prop */
+	FVector Location;
+
+	/** Distance from the trace start to Location */
+	float Distance;
+
+	FGGTRewindHit()
+		: Component(nullptr)
+		, Location(ForceInit)
+		, Distance(0.0f)
+	{
+	}
+};
+
+
+/**
+ * Server side history of the transforms of grabbable props, used to validate client traces against the world as the client saw it.
+ * All history lives in one ring buffer allocated up front from MemoryBudgetKB, so the memory cost does not grow with play time.
+ * A rewind query costs one binary search over the sample times and one box test per tracked prop.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTRewindBuffer : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTRewindBuffer();
+
+		/** How much memory the transform history may use in total */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind Buffer", meta = (ClampMin = "1"))
+		int32 MemoryBudgetKB;
+
+		/** How many props can be tracked at the same time, the memory budget is shared between them */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind Buffer", meta = (ClampMin = "1"))
+		int32 MaxTrackedProps;
+
+		/** How far back in time a trace can be rewound. Clients with more latency than this are traced at the oldest sample. */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind Buffer", meta = (ClampMin = "0.0"))
+		float MaxRewindTime;
+
+
+		/** Starts tracking the provided component, returns the handle used to unregister it or INDEX_NONE if the buffer is full */
+		int32 RegisterProp(UPrimitiveComponent* Component);
+
+		/** Stops tracking the prop with the provided handle */
+		void UnregisterProp(int32 Handle);
+
+		/** Traces a line against the props as they were at the provided world time.
+		*	Returns true if a prop was hit, OutHit then holds the closest hit.
+		*/
+		bool RewindLineTrace(const FVector& Start, const FVector& End, float WorldTime, FGGTRewindHit& OutHit) const;
+
+		/** Get the transform a tracked prop had at the provided world time, returns false if the handle is not tracked */
+		bool GetPropTransformAtTime(int32 Handle, float WorldTime, FTransform& OutTransform) const;
+
+		/** Get the handles of every tracked prop */
+		const TArray<int32>& GetTrackedHandles() const { return ActiveHandles; }
+
+		/** Get the component of a tracked prop */
+		UPrimitiveComponent* GetTrackedComponent(int32 Handle) const;
+
+		/** Get the memory used by the history */
+		int32 GetAllocatedBytes() const;
+
+		/** Called every frame */
+		virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+	private:
+
+		/** One recorded transform, scale is stored once per prop since props don't change scale */
+		struct FRewindSample
+		{
+			FVector Location;
+			FQuat Rotation;
+		};
+
+		struct FTrackedProp
+		{
+			TWeakObjectPtr<UPrimitiveComponent> Component;
+
+			/** Local space bounds including the scale of the component */
+			FBox LocalBox;
+			float Radius;
+		};
+
+		/** Every prop slot, indexed by handle */
+		TArray<FTrackedProp> TrackedProps;
+		TArray<int32> ActiveHandles;
+		TArray<int32> FreeHandles;
+
+		/** The history, SamplesPerProp entries per handle. The sample times are shared since all props are recorded together. */
+		TArray<FRewindSample> Samples;
+		TArray<float> SampleTimes;
+		int32 SamplesPerProp;
+
+		/** Ring buffer position of the newest sample, and how many samples have been recorded */
+		int32 NewestSample;
+		int32 NumSamples;
+
+		/** How often a sample is recorded so that the history covers MaxRewindTime */
+		float RecordInterval;
+		float LastRecordTime;
+
+		/** Allocates the history from the memory budget the first time it's needed */
+		void AllocateHistory();
+
+		/** Records the current transform of every tracked prop */
+		void RecordSamples(float WorldTime);
+
+		/** Finds the two ring buffer indices around the provided time and the blend between them */
+		bool FindSamplePair(float WorldTime, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+
+		/** Blends the two samples of a prop */
+		FTransform BlendSamples(int32 Handle, int32 Older, int32 Newer, float Alpha) const;
+};
@@ -0,0 +1,307 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTSoakTest.h"
+
+#include "GGTGameState.h"
+#include "GGTEffectScheduler.h"
+#include "GGTPropReplication.h"
+#include "Props/GGTProp.h"
+#include "Player/GGTSoakBotController.h"
+#include "Weapons/GravityGun.h"
+
+
+AGGTSoakTest::AGGTSoakTest()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	NumBots = 8;
+	NumProps = 0;
+	DurationHours = 4.0f;
+	SampleInterval = 10.0f;
+	WarmupTime = 120.0f;
+
+	MaxMemoryGrowthMB = 256.0f;
+	MaxObjectGrowthPercent = 10.0f;
+	MaxGCPauseMs = 100.0f;
+	MaxFrameTimeP99Ms = 50.0f;
+	MaxAudioComponents = 256;
+	MaxEffectEntriesPerBot = 4;
+	MinGrabsPerBot = 1;
+
+	bHasBaseline = false;
+	NextSampleTime = 0.0f;
+	GCStartTime = 0.0;
+	MaxGCPauseSinceSample = 0.0f;
+}
+
+void AGGTSoakTest::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The command line overrides the defaults
+	FParse::Value(FCommandLine::Get(), TEXT("ggtsoakbots="), NumBots);
+	FParse::Value(FCommandLine::Get(), TEXT("ggtsoakhours="), DurationHours);
+	FParse::Value(FCommandLine::Get(), TEXT("ggtsoakprops="), NumProps);
+
+	PreGCHandle = FCoreUObjectDelegates::PreGarbageCollect.AddUObject(this, &AGGTSoakTest::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::PostGarbageCollect.AddUObject(this, &AGGTSoakTest::OnPostGarbageCollect);
+
+	FrameTimes.Reserve(FMath::CeilToInt(SampleInterval * 120.0f));
+	NextSampleTime = GetWorld()->GetTimeSeconds() + SampleInterval;
+
+	SpawnBots();
+
+	// The extra props go in a grid next to the bots, where they can reach some of them
+	int32 SpawnedProps = 0;
+	if (NumProps > 0)
+	{
+		AActor* Start = GetWorld()->GetAuthGameMode() ? GetWorld()->GetAuthGameMode()->FindPlayerStart(nullptr) : nullptr;
+		const FVector Center = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+		SpawnedProps = AGGTProp::SpawnGrid(GetWorld(), Center + FVector(500.0f, 0.0f, 0.0f), FVector::ForwardVector, NumProps, 150.0f);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSoak: started with %d bots and %d extra props for %.1f hours"), Bots.Num(), SpawnedProps, DurationHours);
+}
+
+void AGGTSoakTest::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreUObjectDelegates::PreGarbageCollect.Remove(PreGCHandle);
+	FCoreUObjectDelegates::PostGarbageCollect.Remove(PostGCHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGGTSoakTest::SpawnBots()
+{
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (GameMode == nullptr || GameMode->DefaultPawnClass == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTSoak: the game mode has no default pawn to give the bots"));
+		return;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < NumBots; i++)
+	{
+		AGGTSoakBotController* Bot = GetWorld()->SpawnActor<AGGTSoakBotController>(SpawnInfo);
+		if (Bot == nullptr)
+			continue;
+
+		// Spread the bots in a circle around the start so they share the props in the middle
+		AActor* Start = GameMode->FindPlayerStart(Bot);
+		const FVector Center = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+		const float Angle = (2.0f * PI * i) / NumBots;
+		const FVector Location = Center + (FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * 300.0f);
+
+		APawn* Pawn = GetWorld()->SpawnActor<APawn>(GameMode->DefaultPawnClass, Location, (Center - Location).Rotation(), SpawnInfo);
+		if (Pawn)
+			Bot->Possess(Pawn);
+
+		Bots.Add(Bot);
+	}
+}
+
+void AGGTSoakTest::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// The game thread time of the last frame, without the time a server waits for its tick rate
+	FrameTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	if (CurrentTime < NextSampleTime)
+		return;
+
+	NextSampleTime = CurrentTime + SampleInterval;
+
+	const FGGTSoakSample Sample = TakeSample();
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSoak: %7.0f s, %6.1f MB, %7d objects, gc %6.1f ms, frame p50 %5.2f p95 %5.2f p99 %5.2f ms, %d audio, %d effects, %d orphaned grabs"),
+		Sample.Time, Sample.UsedPhysicalBytes / (1024.0 * 1024.0), Sample.ObjectCount, Sample.MaxGCPauseMs,
+		Sample.FrameTimeP50Ms, Sample.FrameTimeP95Ms, Sample.FrameTimeP99Ms, Sample.AudioComponents, Sample.EffectEntries, Sample.OrphanedGrabs);
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSoak: %7.0f s, %d of %d grabs caught an object"), Sample.Time, Sample.Grabs, Sample.GrabAttempts);
+
+	UE_LOG(LogTemp, Log, TEXT("GGTSoak: %7.0f s, %d clients, %.0f prop bytes and %.0f total bytes per client per second, net flush %.2f ms/s, %d dormant props"),
+		Sample.Time, Sample.NetClients, Sample.NetPropBytesPerClient, Sample.NetBytesPerClient, Sample.NetFlushMsPerSecond, Sample.DormantProps);
+
+	if (!bHasBaseline)
+	{
+		if (CurrentTime >= WarmupTime)
+		{
+			Baseline = Sample;
+			bHasBaseline = true;
+		}
+		return;
+	}
+
+	FString Reason;
+	if (!CheckThresholds(Sample, Reason))
+	{
+		FinishTest(false, Reason);
+		return;
+	}
+
+	if (CurrentTime >= WarmupTime + (DurationHours * 3600.0f))
+		FinishTest(true, FString());
+}
+
+FGGTSoakSample AGGTSoakTest::TakeSample()
+{
+	UWorld* World = GetWorld();
+
+	FGGTSoakSample Sample;
+	Sample.Time = World->GetTimeSeconds();
+	Sample.UsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+	Sample.ObjectCount = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	Sample.MaxGCPauseMs = MaxGCPauseSinceSample;
+	MaxGCPauseSinceSample = 0.0f;
+
+	// Frame time percentiles of the frames since the last sample
+	Sample.FrameTimeP50Ms = Sample.FrameTimeP95Ms = Sample.FrameTimeP99Ms = 0.0f;
+	if (FrameTimes.Num() > 0)
+	{
+		FrameTimes.Sort();
+		const int32 Last = FrameTimes.Num() - 1;
+		Sample.FrameTimeP50Ms = FrameTimes[FMath::RoundToInt(Last * 0.50f)];
+		Sample.FrameTimeP95Ms = FrameTimes[FMath::RoundToInt(Last * 0.95f)];
+		Sample.FrameTimeP99Ms = FrameTimes[FMath::RoundToInt(Last * 0.99f)];
+		FrameTimes.Reset();
+	}
+
+	// Spawned sounds should destroy themselves when they finish
+	Sample.AudioComponents = 0;
+	for (TObjectIterator<UAudioComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World)
+			Sample.AudioComponents++;
+	}
+
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	Sample.EffectEntries = (GameState && GameState->EffectScheduler) ? GameState->EffectScheduler->GetPendingCount() : 0;
+
+	// Network cost since the last sample
+	Sample.NetClients = 0;
+	Sample.NetBytesPerClient = 0.0f;
+	Sample.NetPropBytesPerClient = 0.0f;
+	Sample.NetFlushMsPerSecond = 0.0f;
+	Sample.DormantProps = 0;
+	if (GameState && GameState->PropReplication)
+	{
+		const FGGTPropNetStats NetStats = GameState->PropReplication->TakeStats();
+		Sample.NetClients = NetStats.NumClients;
+		Sample.NetBytesPerClient = NetStats.AverageBytesPerClient;
+		Sample.NetPropBytesPerClient = NetStats.AveragePropBytesPerClient;
+		Sample.NetFlushMsPerSecond = NetStats.NetFlushMsPerSecond;
+		Sample.DormantProps = NetStats.NumDormant;
+	}
+
+	// Grabs the bots made since the last sample
+	Sample.GrabAttempts = 0;
+	Sample.Grabs = 0;
+	for (AController* Bot : Bots)
+	{
+		AGGTSoakBotController* SoakBot = Cast<AGGTSoakBotController>(Bot);
+		if (SoakBot == nullptr)
+			continue;
+
+		int32 Attempts = 0;
+		int32 Grabs = 0;
+		SoakBot->TakeGrabCounts(Attempts, Grabs);
+		Sample.GrabAttempts += Attempts;
+		Sample.Grabs += Grabs;
+	}
+
+	// A gun that is free or put away should never hold anything
+	Sample.OrphanedGrabs = 0;
+	for (TActorIterator<AGravityGun> It(World); It; ++It)
+	{
+		const bool bGrabbing = It->PhysicsHandle && It->PhysicsHandle->GetGrabbedComponent();
+		const bool bInUse = It->GetState() == EWeaponStates::WS_Held && It->IsWeaponActive() && It->GetHolder();
+		if (bGrabbing && !bInUse)
+			Sample.OrphanedGrabs++;
+	}
+
+	return Sample;
+}
+
+bool AGGTSoakTest::CheckThresholds(const FGGTSoakSample& Sample, FString& OutReason) const
+{
+	const double MemoryGrowthMB = ((double)Sample.UsedPhysicalBytes - (double)Baseline.UsedPhysicalBytes) / (1024.0 * 1024.0);
+	if (MemoryGrowthMB > MaxMemoryGrowthMB)
+	{
+		OutReason = FString::Printf(TEXT("resident memory grew %.1f MB, the limit is %.1f MB"), MemoryGrowthMB, MaxMemoryGrowthMB);
+		return false;
+	}
+
+	const float ObjectGrowthPercent = 100.0f * (Sample.ObjectCount - Baseline.ObjectCount) / FMath::Max(Baseline.ObjectCount, 1);
+	if (ObjectGrowthPercent > MaxObjectGrowthPercent)
+	{
+		OutReason = FString::Printf(TEXT("the UObject count grew %.1f%% from %d to %d, the limit is %.1f%%"), ObjectGrowthPercent, Baseline.ObjectCount, Sample.ObjectCount, MaxObjectGrowthPercent);
+		return false;
+	}
+
+	if (Sample.MaxGCPauseMs > MaxGCPauseMs)
+	{
+		OutReason = FString::Printf(TEXT("a garbage collection took %.1f ms, the limit is %.1f ms"), Sample.MaxGCPauseMs, MaxGCPauseMs);
+		return false;
+	}
+
+	if (Sample.FrameTimeP99Ms > MaxFrameTimeP99Ms)
+	{
+		OutReason = FString::Printf(TEXT("the 99th percentile frame took %.2f ms, the limit is %.2f ms"), Sample.FrameTimeP99Ms, MaxFrameTimeP99Ms);
+		return false;
+	}
+
+	if (Sample.AudioComponents > MaxAudioComponents)
+	{
+		OutReason = FString::Printf(TEXT("%d audio components exist, the limit is %d"), Sample.AudioComponents, MaxAudioComponents);
+		return false;
+	}
+
+	if (Sample.EffectEntries > MaxEffectEntriesPerBot * FMath::Max(Bots.Num(), 1))
+	{
+		OutReason = FString::Printf(TEXT("%d effect deactivations are pending, the limit is %d"), Sample.EffectEntries, MaxEffectEntriesPerBot * FMath::Max(Bots.Num(), 1));
+		return false;
+	}
+
+	if (Sample.OrphanedGrabs > 0)
+	{
+		OutReason = FString::Printf(TEXT("%d guns hold an object while they are dropped or put away"), Sample.OrphanedGrabs);
+		return false;
+	}
+
+	if (Sample.Grabs < MinGrabsPerBot * Bots.Num())
+	{
+		OutReason = FString::Printf(TEXT("only %d of %d grabs caught an object, the minimum is %d"), Sample.Grabs, Sample.GrabAttempts, MinGrabsPerBot * Bots.Num());
+		return false;
+	}
+
+	return true;
+}
+
+void AGGTSoakTest::FinishTest(bool bPassed, const FString& Reason)
+{
+	if (bPassed)
+		UE_LOG(LogTemp, Log, TEXT("GGTSoak: PASSED after %.1f hours"), DurationHours);
+	else
+		UE_LOG(LogTemp, Error, TEXT("GGTSoak: FAILED, %s"), *Reason);
+
+	SetActorTickEnabled(false);
+	FPlatformMisc::RequestExit(false);
+}
+
+void AGGTSoakTest::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void AGGTSoakTest::OnPostGarbageCollect()
+{
+	const float PauseMs = (FPlatformTime::Seconds() - GCStartTime) * 1000.0;
+	MaxGCPauseSinceSample = FMath::Max(MaxGCPauseSinceSample, PauseMs);
+}
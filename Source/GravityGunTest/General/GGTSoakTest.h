@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "GGTSoakTest.generated.h"
+
+
+/** One measurement of the soak test */
+struct FGGTSoakSample
+{
+	float Time;
+	uint64 UsedPhysicalBytes;
+	int32 ObjectCount;
+	float MaxGCPauseMs;
+	float FrameTimeP50Ms;
+	float FrameTimeP95Ms;
+	float FrameTimeP99Ms;
+	int32 AudioComponents;
+	int32 EffectEntries;
+	int32 OrphanedGrabs;
+	int32 GrabAttempts;
+	int32 Grabs;
+	int32 NetClients;
+	float NetBytesPerClient;
+	float NetPropBytesPerClient;
+	float NetFlushMsPerSecond;
+	int32 DormantProps;
+};
+
+
+/**
+ * Long running server test with scripted bots that grab, fire, drop and re-equip weapons.
+ * The resources of the server are sampled on an interval and compared with the first sample after the warmup.
+ * When a threshold is crossed the test logs an error and exits, so leaks show up in an unattended run.
+ * Spawned by the game mode when the server is started with -ggtsoak, optionally with -ggtsoakbots=N, -ggtsoakhours=H and -ggtsoakprops=N.
+ * Headless clients connected to the server show up in the network numbers of the samples.
+ */
+UCLASS()
+class GRAVITYGUNTEST_API AGGTSoakTest : public AInfo
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		AGGTSoakTest();
+
+		/** How many bots play during the test */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak", meta = (ClampMin = "1"))
+		int32 NumBots;
+
+		/** How long the test runs before it passes */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak", meta = (ClampMin = "0.0"))
+		float DurationHours;
+
+		/** How many extra props are spawned at the start, to measure the replication with many props */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak", meta = (ClampMin = "0"))
+		int32 NumProps;
+
+		/** Seconds between two samples */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak", meta = (ClampMin = "1.0"))
+		float SampleInterval;
+
+		/** Seconds before the baseline is taken, so that loading and the first spawns are not counted as growth */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak", meta = (ClampMin = "0.0"))
+		float WarmupTime;
+
+
+		/** How much the resident memory may grow over the baseline */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		float MaxMemoryGrowthMB;
+
+		/** How much the UObject count may grow over the baseline, in percent */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		float MaxObjectGrowthPercent;
+
+		/** The longest garbage collection allowed */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		float MaxGCPauseMs;
+
+		/** The highest 99th percentile of the game thread time allowed in a sample */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		float MaxFrameTimeP99Ms;
+
+		/** The most audio components allowed at once, spawned sounds that are never destroyed pile up here */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		int32 MaxAudioComponents;
+
+		/** The most pending effect deactivations allowed per bot, deactivations that are never removed pile up here */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds")
+		int32 MaxEffectEntriesPerBot;
+
+		/** The fewest successful grabs per bot in a sample, bots that can't aim or guns that can't grab stop here */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Soak|Thresholds", meta = (ClampMin = "0"))
+		int32 MinGrabsPerBot;
+
+
+		/** Called every frame */
+		virtual void Tick(float DeltaTime) override;
+
+
+	protected:
+
+		/** The bots that were spawned for the test */
+		UPROPERTY()
+		TArray<AController*> Bots;
+
+		/** The first sample after the warmup, and if it has been taken */
+		FGGTSoakSample Baseline;
+		bool bHasBaseline;
+
+		/** Game thread time of every frame since the last sample */
+		TArray<float> FrameTimes;
+
+		float NextSampleTime;
+
+		/** The longest garbage collection since the last sample */
+		double GCStartTime;
+		float MaxGCPauseSinceSample;
+		FDelegateHandle PreGCHandle;
+		FDelegateHandle PostGCHandle;
+
+		void OnPreGarbageCollect();
+		void OnPostGarbageCollect();
+
+		/** Spawns the bots and their characters around the player start */
+		void SpawnBots();
+
+		/** Measures the resources of the server */
+		FGGTSoakSample TakeSample();
+
+		/** Compares the sample with the baseline, returns the reason if a threshold was crossed */
+		bool CheckThresholds(const FGGTSoakSample& Sample, FString& OutReason) const;
+
+		/** Logs the result and stops the server */
+		void FinishTest(bool bPassed, const FString& Reason);
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+
+		/** Called when the test is removed */
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTTelemetry.h"
+
+#include "GGTGameState.h"
+
+
+FGGTTelemetryRing::FGGTTelemetryRing(int32 Capacity)
+{
+	Records.SetNumUninitialized(FMath::RoundUpToPowerOfTwo(FMath::Max(Capacity, 2)));
+	Mask = Records.Num() - 1;
+	Head = 0;
+	Tail = 0;
+}
+
+bool FGGTTelemetryRing::Push(const FGGTTelemetryRecord& Record)
+{
+	const uint32 CurrentHead = Head;
+	if (CurrentHead - Tail > Mask)
+	{
+		DroppedCount.Increment();
+		return false;
+	}
+
+	Records[CurrentHead & Mask] = Record;
+
+	// The record has to be written before the writer can see the new head
+	FPlatformMisc::MemoryBarrier();
+	Head = CurrentHead + 1;
+	return true;
+}
+
+void FGGTTelemetryRing::Drain(TArray<FGGTTelemetryRecord>& OutRecords)
+{
+	const uint32 CurrentHead = Head;
+	FPlatformMisc::MemoryBarrier();
+
+	for (uint32 Index = Tail; Index != CurrentHead; Index++)
+	{
+		OutRecords.Add(Records[Index & Mask]);
+	}
+
+	// The records have to be read before the producer can overwrite them
+	FPlatformMisc::MemoryBarrier();
+	Tail = CurrentHead;
+}
+
+
+/** Background thread that drains the rings into the telemetry file */
+class FGGTTelemetryWriter : public FRunnable
+{
+	public:
+
+		FGGTTelemetryWriter(UGGTTelemetry* InTelemetry, IFileHandle* InFile, float InFlushInterval)
+			: Telemetry(InTelemetry)
+			, File(InFile)
+			, FlushInterval(InFlushInterval)
+		{
+		}
+
+		virtual ~FGGTTelemetryWriter()
+		{
+			delete File;
+		}
+
+		virtual uint32 Run() override
+		{
+			while (StopRequested.GetValue() == 0)
+			{
+				FPlatformProcess::Sleep(FlushInterval);
+				Flush();
+			}
+
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			StopRequested.Set(1);
+		}
+
+		/** Writes every buffered record to the file, also called after the thread has stopped for the last records */
+		void Flush()
+		{
+			Buffer.Reset();
+			{
+				FScopeLock Lock(&Telemetry->RingsLock);
+				for (FGGTTelemetryRing* Ring : Telemetry->Rings)
+				{
+					Ring->Drain(Buffer);
+				}
+			}
+
+			if (Buffer.Num() > 0)
+				File->Write(reinterpret_cast<const uint8*>(Buffer.GetData()), Buffer.Num() * sizeof(FGGTTelemetryRecord));
+		}
+
+	private:
+
+		UGGTTelemetry* Telemetry;
+		IFileHandle* File;
+		float FlushInterval;
+		FThreadSafeCounter StopRequested;
+
+		/** Reused between flushes */
+		TArray<FGGTTelemetryRecord> Buffer;
+};
+
+
+UGGTTelemetry::UGGTTelemetry()
+{
+	bRecordTelemetry = false;
+	RingCapacity = 4096;
+	FlushInterval = 0.5f;
+
+	RingTlsSlot = 0;
+	Writer = nullptr;
+	WriterThread = nullptr;
+}
+
+void UGGTTelemetry::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!bRecordTelemetry && !FParse::Param(FCommandLine::Get(), TEXT("ggttelemetry")))
+		return;
+
+	// One file per play session
+	const FString FileName = FPaths::GameSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("GGT_%s.ggtt"), *FDateTime::Now().ToString());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FileName));
+
+	IFileHandle* File = PlatformFile.OpenWrite(*FileName);
+	if (File == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GGTTelemetry: could not open %s"), *FileName);
+		return;
+	}
+
+	FGGTTelemetryFileHeader Header;
+	Header.Magic = FGGTTelemetryFileHeader::CurrentMagic;
+	Header.Version = FGGTTelemetryFileHeader::CurrentVersion;
+	Header.RecordSize = sizeof(FGGTTelemetryRecord);
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	RingTlsSlot = FPlatformTLS::AllocTlsSlot();
+	Writer = new FGGTTelemetryWriter(this, File, FlushInterval);
+	WriterThread = FRunnableThread::Create(Writer, TEXT("GGTTelemetryWriter"), 0, TPri_BelowNormal);
+
+	UE_LOG(LogTemp, Log, TEXT("GGTTelemetry: recording to %s"), *FileName);
+}
+
+void UGGTTelemetry::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGGTTelemetry::StopRecording()
+{
+	if (Writer == nullptr)
+		return;
+
+	// Wait for the thread, then write what was recorded since its last flush
+	WriterThread->Kill(true);
+	delete WriterThread;
+	WriterThread = nullptr;
+
+	Writer->Flush();
+	delete Writer;
+	Writer = nullptr;
+
+	if (GetDroppedCount() > 0)
+		UE_LOG(LogTemp, Warning, TEXT("GGTTelemetry: %d records were dropped, increase RingCapacity or lower FlushInterval"), GetDroppedCount());
+
+	// Only the ring pointer of this thread can be cleared, a later slot starts out empty on every thread
+	FPlatformTLS::SetTlsValue(RingTlsSlot, nullptr);
+	FPlatformTLS::FreeTlsSlot(RingTlsSlot);
+	RingTlsSlot = 0;
+
+	for (FGGTTelemetryRing* Ring : Rings)
+	{
+		delete Ring;
+	}
+	Rings.Empty();
+}
+
+FGGTTelemetryRing* UGGTTelemetry::GetThreadRing()
+{
+	FGGTTelemetryRing* Ring = static_cast<FGGTTelemetryRing*>(FPlatformTLS::GetTlsValue(RingTlsSlot));
+	if (Ring)
+		return Ring;
+
+	// First record of this thread
+	Ring = new FGGTTelemetryRing(RingCapacity);
+	FPlatformTLS::SetTlsValue(RingTlsSlot, Ring);
+
+	FScopeLock Lock(&RingsLock);
+	Rings.Add(Ring);
+	return Ring;
+}
+
+void UGGTTelemetry::Record(EGGTTelemetryEvent Type, const AActor* Weapon, const UPrimitiveComponent* Object, float Value)
+{
+	if (Writer == nullptr)
+		return;
+
+	FGGTTelemetryRecord Record;
+	Record.Time = GetWorld()->GetTimeSeconds();
+	Record.Type = (uint8)Type;
+	Record.Padding[0] = Record.Padding[1] = Record.Padding[2] = 0;
+	Record.WeaponId = Weapon ? Weapon->GetUniqueID() : 0;
+	Record.WeaponLocation = Weapon ? Weapon->GetActorLocation() : FVector::ZeroVector;
+	Record.ObjectId = Object ? Object->GetUniqueID() : 0;
+	Record.ObjectLocation = Object ? Object->GetComponentLocation() : FVector::ZeroVector;
+	Record.Mass = (Object && Object->IsSimulatingPhysics()) ? Object->GetMass() : 0.0f;
+	Record.Value = Value;
+
+	GetThreadRing()->Push(Record);
+}
+
+void UGGTTelemetry::RecordEvent(const UObject* WorldContextObject, EGGTTelemetryEvent Type, const AActor* Weapon, const UPrimitiveComponent* Object, float Value)
+{
+	AGGTGameState* GameState = AGGTGameState::Get(WorldContextObject);
+	if (GameState && GameState->Telemetry)
+		GameState->Telemetry->Record(Type, Weapon, Object, Value);
+}
+
+int32 UGGTTelemetry::GetDroppedCount() const
+{
+	int32 Dropped = 0;
+
+	FScopeLock Lock(&RingsLock);
+	for (const FGGTTelemetryRing* Ring : Rings)
+	{
+		Dropped += Ring->GetDroppedCount();
+	}
+	return Dropped;
+}
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GGTTelemetry.generated.h"
+
+
+class FGGTTelemetryWriter;
+
+
+/** The gameplay events the telemetry records */
+enum class EGGTTelemetryEvent : uint8
+{
+	Grab,
+	Fire,
+	DistanceRelease,
+	Drop,
+	Equip
+};
+
+
+/** One recorded event. Fixed size and written to the file as is, so the layout is the file format. */
+struct FGGTTelemetryRecord
+{
+	/** World time of the event */
+	float Time;
+
+	/** EGGTTelemetryEvent */
+	uint8 Type;
+	uint8 Padding[3];
+
+	/** Unique ids of the weapon and the object, 0 if there is none */
+	uint32 WeaponId;
+	uint32 ObjectId;
+
+	/** Where the weapon and the object were */
+	FVector WeaponLocation;
+	FVector ObjectLocation;
+
+	/** Mass of the object, 0 if there is none */
+	float Mass;
+
+	/** Depends on the event: the launch speed for fire, the distance for grabs and distance releases, the slot for drops and equips */
+	float Value;
+};
+
+static_assert(sizeof(FGGTTelemetryRecord) == 48, "The telemetry file format depends on the record size");
+
+
+/** The header at the start of a telemetry file */
+struct FGGTTelemetryFileHeader
+{
+	/** 'GGTT' */
+	uint32 Magic;
+	uint32 Version;
+	uint32 RecordSize;
+
+	static const uint32 CurrentMagic = 0x54544747;
+	static const uint32 CurrentVersion = 1;
+};
+
+
+/** Ring buffer with one producer thread and one consumer thread, full rings drop new records instead of waiting */
+class FGGTTelemetryRing
+{
+	public:
+
+		/** The capacity is rounded up to a power of two */
+		explicit FGGTTelemetryRing(int32 Capacity);
+
+		/** Adds a record, returns false if the ring was full. Only called by the owning thread. */
+		bool Push(const FGGTTelemetryRecord& Record);
+
+		/** Moves every record in the ring to the end of OutRecords. Only called by the writer thread. */
+		void Drain(TArray<FGGTTelemetryRecord>& OutRecords);
+
+		/** How many records were dropped because the ring was full */
+		int32 GetDroppedCount() const { return DroppedCount.GetValue(); }
+
+	private:
+
+		TArray<FGGTTelemetryRecord> Records;
+		uint32 Mask;
+
+		/** Written by the producer and the consumer only, read by the other one after a barrier */
+		volatile uint32 Head;
+		volatile uint32 Tail;
+
+		FThreadSafeCounter DroppedCount;
+};
+
+
+/**
+ * Records gravity gun gameplay events for tuning, into a local binary file.
+ * Recording copies the event into a ring buffer of the calling thread, and a background thread writes the rings to the file,
+ * so the game thread never waits on a lock or on the disk. Convert the file with the GGTTelemetryToCSV commandlet.
+ * Turned off by default, turn it on with bRecordTelemetry or the -ggttelemetry command line switch.
+ */
+UCLASS(ClassGroup = "Systems")
+class GRAVITYGUNTEST_API UGGTTelemetry : public UActorComponent
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTTelemetry();
+
+		/** If events should be recorded */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Telemetry")
+		bool bRecordTelemetry;
+
+		/** How many records every thread can buffer before the writer catches up, new records are dropped when it's full */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Telemetry", meta = (ClampMin = "64"))
+		int32 RingCapacity;
+
+		/** Seconds between the writes to the file */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Telemetry", meta = (ClampMin = "0.01"))
+		float FlushInterval;
+
+
+		/** Records an event of the weapon, and the object it concerns if there is one */
+		void Record(EGGTTelemetryEvent Type, const AActor* Weapon, const UPrimitiveComponent* Object, float Value);
+
+		/** Records the event with the telemetry of the world the object is in, does nothing if it's not recording */
+		static void RecordEvent(const UObject* WorldContextObject, EGGTTelemetryEvent Type, const AActor* Weapon, const UPrimitiveComponent* Object, float Value);
+
+		/** If events are being recorded */
+		bool IsRecording() const { return Writer != nullptr; }
+
+		/** How many records were dropped because a ring was full */
+		int32 GetDroppedCount() const;
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+
+		/** Called when the game ends, writes the remaining records */
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+	private:
+
+		/** Every thread that recorded gets a ring, the lock is only taken when a thread records for the first time and by the writer */
+		TArray<FGGTTelemetryRing*> Rings;
+		mutable FCriticalSection RingsLock;
+
+		/** Thread local slot holding the ring of the current thread */
+		uint32 RingTlsSlot;
+
+		/** Get the ring of the current thread, creates it on the first call */
+		FGGTTelemetryRing* GetThreadRing();
+
+		/** Writes the rings to the file on a background thread */
+		FGGTTelemetryWriter* Writer;
+		FRunnableThread* WriterThread;
+
+		void StopRecording();
+
+		friend class FGGTTelemetryWriter;
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTTelemetryToCSVCommandlet.h"
+
+#include "GGTTelemetry.h"
+
+
+UGGTTelemetryToCSVCommandlet::UGGTTelemetryToCSVCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UGGTTelemetryToCSVCommandlet::Main(const FString& Params)
+{
+	FString InFile;
+	if (!FParse::Value(*Params, TEXT("in="), InFile))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTTelemetryToCSV: missing -in=<file.ggtt>"));
+		return 1;
+	}
+
+	FString OutFile;
+	if (!FParse::Value(*Params, TEXT("out="), OutFile))
+		OutFile = FPaths::ChangeExtension(InFile, TEXT("csv"));
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *InFile))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTTelemetryToCSV: could not read %s"), *InFile);
+		return 1;
+	}
+
+	// Check that the file was written with the same record layout
+	FGGTTelemetryFileHeader Header;
+	if (Data.Num() < (int32)sizeof(Header))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTTelemetryToCSV: %s is too small to be a telemetry file"), *InFile);
+		return 1;
+	}
+
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+	if (Header.Magic != FGGTTelemetryFileHeader::CurrentMagic || Header.Version != FGGTTelemetryFileHeader::CurrentVersion || Header.RecordSize != sizeof(FGGTTelemetryRecord))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTTelemetryToCSV: %s is not a version %u telemetry file"), *InFile, FGGTTelemetryFileHeader::CurrentVersion);
+		return 1;
+	}
+
+	static const TCHAR* EventNames[] = { TEXT("Grab"), TEXT("Fire"), TEXT("DistanceRelease"), TEXT("Drop"), TEXT("Equip") };
+
+	const int32 NumRecords = (Data.Num() - sizeof(Header)) / sizeof(FGGTTelemetryRecord);
+	const FGGTTelemetryRecord* Records = reinterpret_cast<const FGGTTelemetryRecord*>(Data.GetData() + sizeof(Header));
+
+	FString CSV = TEXT("Time,Event,WeaponId,WeaponX,WeaponY,WeaponZ,ObjectId,ObjectX,ObjectY,ObjectZ,Mass,Value\n");
+	CSV.Reserve(NumRecords * 128);
+
+	for (int32 i = 0; i < NumRecords; i++)
+	{
+		// The records are copied out since the array data has no alignment guarantee past the header
+		FGGTTelemetryRecord Record;
+		FMemory::Memcpy(&Record, &Records[i], sizeof(Record));
+
+		const TCHAR* EventName = Record.Type < ARRAY_COUNT(EventNames) ? EventNames[Record.Type] : TEXT("Unknown");
+
+		CSV += FString::Printf(TEXT("%.4f,%s,%u,%.1f,%.1f,%.1f,%u,%.1f,%.1f,%.1f,%.3f,%.3f\n"), Record.Time, EventName,
+			Record.WeaponId, Record.WeaponLocation.X, Record.WeaponLocation.Y, Record.WeaponLocation.Z,
+			Record.ObjectId, Record.ObjectLocation.X, Record.ObjectLocation.Y, Record.ObjectLocation.Z,
+			Record.Mass, Record.Value);
+	}
+
+	if (!FFileHelper::SaveStringToFile(CSV, *OutFile))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GGTTelemetryToCSV: could not write %s"), *OutFile);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("GGTTelemetryToCSV: wrote %d events to %s"), NumRecords, *OutFile);
+	return 0;
+}
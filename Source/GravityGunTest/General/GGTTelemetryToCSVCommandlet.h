@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "GGTTelemetryToCSVCommandlet.generated.h"
+
+/**
+ * Converts a telemetry file recorded by UGGTTelemetry to CSV, one row per event.
+ * Usage: UE4Editor-Cmd GravityGunTest -run=GGTTelemetryToCSV -in=<file.ggtt> [-out=<file.csv>]
+ */
+UCLASS()
+class GRAVITYGUNTEST_API UGGTTelemetryToCSVCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		UGGTTelemetryToCSVCommandlet();
+
+		/** Runs the conversion, returns 0 on success */
+		virtual int32 Main(const FString& Params) override;
+};
@@ -4,7 +4,8 @@
 #include "GGTCharacter.h"
 
 #include "GGTPlayerController.h"
-#include "Weapons/GravityGun.h"
+#include "General/GGTTelemetry.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 AGGTCharacter::AGGTCharacter()
@@ -25,19 +26,40 @@ AGGTCharacter::AGGTCharacter()
 	PlayerMesh->CastShadow = false;
 	PlayerMesh->RelativeRotation = FRotator(1.9f, -19.19f, 5.2f);
 	PlayerMesh->RelativeLocation = FVector(-0.5f, -4.4f, -155.7f);
+
+	WeaponSlotCount = 3;
+	ActiveWeaponSlot = INDEX_NONE;
+
+	PickupRadius = 300.0f;
+	PickupRefreshInterval = 0.2f;
+	PickupRefreshTime = -BIG_NUMBER;
+	PickupViewAngle = 30.0f;
+	MaxTraceStartError = 150.0f;
+	MaxFireDelayTolerance = 0.1f;
+
+	LastPredictionKey = 0;
+	LastAckedPredictionKey = 0;
+	PendingInventoryKey = 0;
+	PredictionSendTimes.Init(0.0f, 32);
+	PredictionWeapons.SetNum(32);
 }
 
 // Called when the game starts or when spawned
 void AGGTCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Create the empty inventory slots, on clients the slots of the server may already have arrived
+	if (WeaponSlots.Num() == 0)
+		WeaponSlots.Init(nullptr, FMath::Max(WeaponSlotCount, 1));
 	
-	// Spawn and equip the start weapon if there is a valid class
-	if (StartWeaponClass)
+	// Spawn and equip the start weapon if there is a valid class, the weapons are replicated from the server
+	if (StartWeaponClass && HasAuthority())
 	{
 		// Spawn parameters
 		FActorSpawnParameters SpawnInfo;
 		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnInfo.Owner = this;
 		SpawnInfo.Instigator = Instigator;
 		SpawnInfo.bDeferConstruction = false;
 
@@ -49,11 +71,21 @@ void AGGTCharacter::BeginPlay()
 	// Get the controller and store it
 	if (GetController())
 		GGTController = Cast<AGGTPlayerController>(GetController());
+}
+
+void AGGTCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	// Trace parameters
-	TraceParams = FCollisionQueryParams(FName(TEXT("Hover Trace")), false, nullptr);
-	TraceParams.bReturnPhysicalMaterial = false;
-	TraceParams.bTraceComplex = false;
+	DOREPLIFETIME(AGGTCharacter, WeaponSlots);
+	DOREPLIFETIME(AGGTCharacter, ActiveWeaponSlot);
+}
+
+const FCollisionQueryParams& AGGTCharacter::GetHoverTraceParams()
+{
+	// The crosshair trace ignores nothing, so every character can use the same parameters
+	static const FCollisionQueryParams HoverTraceParams(FName(TEXT("Hover Trace")), false, nullptr);
+	return HoverTraceParams;
 }
 
 // Called every frame
@@ -61,45 +93,45 @@ void AGGTCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (GGTController)
+	UpdateAimRotation();
+
+	// The crosshair is only drawn, so it's updated once per frame rather than on the gameplay steps
+	UpdateCrosshair();
+}
+
+void AGGTCharacter::UpdateCrosshair()
+{
+	// Only the local player has a widget, the server and bots have nothing to show
+	if (GGTController && GGTController->MainWidget)
 	{
 		// Reset the values on the widget
 		GGTController->MainWidget->ShowInteractAlert = false;
 		GGTController->MainWidget->ShowPickupText = false;
 
-		// Do a line traces to see if there is something that can be interacted with
-		// First check if the player is looking at weapons
-		FHitResult hitResult(ForceInit);
-		FVector startFVector = CameraComponent->GetComponentLocation();
-		FVector endFVector = startFVector + (CameraComponent->GetForwardVector() * GGTController->InteractTraceLength);
+		// Check if the player is looking at a weapon that is close enough to be picked up.
+		// The candidates only need to follow the player, so they are refreshed a few times a second.
+		if (GetWorld()->GetTimeSeconds() - PickupRefreshTime >= PickupRefreshInterval)
+			RefreshPickupCandidates();
 
-		if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, TraceParams))
+		if (PickupCandidates.Num() > 0 && FindPickupCandidate(GGTController->InteractTraceLength))
 		{
-			// Check if the trace hits a weapon
-			if (hitResult.GetComponent()->ComponentHasTag("Weapon"))
-			{
-				GGTController->MainWidget->ShowInteractAlert = true;
-				GGTController->MainWidget->ShowPickupText = true;
-			}
+			GGTController->MainWidget->ShowInteractAlert = true;
+			GGTController->MainWidget->ShowPickupText = true;
 		}
 		
-		// Only do next check for gravity guns
-		if (EquippedWeapon && EquippedWeapon->WeaponType == EWeaponType::WT_GravityGun)
+		// Check if the player is looking at something the equipped weapon can interact with.
+		// What to trace for was given by the weapon when it was equipped.
+		if (EquippedTargeting.bHoverTrace)
 		{
-			AGravityGun* GravityGun = Cast<AGravityGun>(EquippedWeapon);
-			if (GravityGun)
-			{
-				// Do the next line trace for objects that can be manipulated by the gravity gun
-				endFVector = startFVector + (CameraComponent->GetForwardVector() * GravityGun->TraceLength);
-				hitResult.Init();
+			FHitResult hitResult(ForceInit);
+			FVector startFVector = CameraComponent->GetComponentLocation();
+			FVector endFVector = startFVector + (CameraComponent->GetForwardVector() * EquippedTargeting.HoverTraceLength);
 
-				if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, TraceParams))
+			if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, GetHoverTraceParams()))
+			{
+				if (EquippedTargeting.IsHoverTarget == nullptr || EquippedTargeting.IsHoverTarget(hitResult.GetComponent()))
 				{
-					// Make sure that the object is simulating physics and is not a weapon
-					if (hitResult.GetComponent()->IsSimulatingPhysics() && !hitResult.GetComponent()->ComponentHasTag("Weapon"))
-					{
-						GGTController->MainWidget->ShowInteractAlert = true;
-					}
+					GGTController->MainWidget->ShowInteractAlert = true;
 				}
 			}
 		}
@@ -111,6 +143,27 @@ bool AGGTCharacter::FireWeapon()
 	if (EquippedWeapon == nullptr)
 		return false;
 
+	UpdateAimRotation();
+
+	// Remote clients fire their own copy of the weapon right away, and let the server fire with the time they saw the world at
+	// so the server can rewind the props. The server answers in ClientAckWeaponAction.
+	if (Role < ROLE_Authority)
+	{
+		// While a pickup or drop is on its way the weapon may change, so only the server fires
+		const bool bPredict = PendingInventoryKey == 0;
+
+		// The cooldown of the copy follows the server, so a fire the server would refuse is not sent
+		if (bPredict && EquippedWeapon->GetFireDelay() > 0.0f)
+			return false;
+
+		const int32 PredictionKey = BeginPrediction(bPredict ? EquippedWeapon : nullptr);
+		if (bPredict)
+			EquippedWeapon->Fire(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector());
+
+		ServerFireWeapon(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector(), GetWorld()->GetGameState()->GetServerWorldTimeSeconds(), PredictionKey);
+		return true;
+	}
+
 	// Fire the weapon
 	EquippedWeapon->Fire(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector());
 
@@ -122,25 +175,233 @@ bool AGGTCharacter::AltFireWeapon()
 	if (EquippedWeapon == nullptr)
 		return false;
 
+	UpdateAimRotation();
+
+	// Remote clients alt fire their copy and let the server alt fire, see FireWeapon
+	if (Role < ROLE_Authority)
+	{
+		const bool bPredict = PendingInventoryKey == 0;
+
+		const int32 PredictionKey = BeginPrediction(bPredict ? EquippedWeapon : nullptr);
+		if (bPredict)
+			EquippedWeapon->AltFire(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector());
+
+		ServerAltFireWeapon(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector(), GetWorld()->GetGameState()->GetServerWorldTimeSeconds(), PredictionKey);
+		return true;
+	}
+
 	// Alt Fire the weapon
 	EquippedWeapon->AltFire(CameraComponent->GetComponentLocation(), CameraComponent->GetForwardVector());
 
 	return true;
 }
 
+void AGGTCharacter::RotateHeldObject(float Yaw, float Pitch)
+{
+	if (EquippedWeapon == nullptr || (Yaw == 0.0f && Pitch == 0.0f))
+		return;
+
+	// The held object is simulated on the server
+	if (Role < ROLE_Authority)
+	{
+		ServerRotateHeldObject(Yaw, Pitch);
+		return;
+	}
+
+	EquippedWeapon->AddHoldRotationInput(Yaw, Pitch);
+}
+
+bool AGGTCharacter::ServerRotateHeldObject_Validate(float Yaw, float Pitch)
+{
+	return FMath::IsFinite(Yaw) && FMath::IsFinite(Pitch);
+}
+
+void AGGTCharacter::ServerRotateHeldObject_Implementation(float Yaw, float Pitch)
+{
+	RotateHeldObject(Yaw, Pitch);
+}
+
+bool AGGTCharacter::ServerFireWeapon_Validate(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey)
+{
+	return !TraceStart.ContainsNaN() && !Direction.ContainsNaN();
+}
+
+void AGGTCharacter::ServerFireWeapon_Implementation(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey)
+{
+	if (EquippedWeapon == nullptr)
+	{
+		SendWeaponAck(PredictionKey, false);
+		return;
+	}
+
+	ValidateClientTrace(TraceStart, Direction);
+
+	// Aim the weapon the way the client aimed, the muzzle decides where the object is launched and held
+	CameraComponent->SetWorldRotation(Direction.Rotation());
+
+	// The client counted its cooldown from when it fired, don't refuse a fire that only arrived a little early
+	if (EquippedWeapon->GetFireDelay() <= MaxFireDelayTolerance)
+		EquippedWeapon->SetFireDelay(0.0f);
+
+	// Fire the weapon against the world as the client saw it
+	EquippedWeapon->SetFireRewindTime(ClientTime);
+	const bool bFired = EquippedWeapon->Fire(TraceStart, Direction);
+	EquippedWeapon->SetFireRewindTime(-1.0f);
+
+	SendWeaponAck(PredictionKey, bFired);
+}
+
+bool AGGTCharacter::ServerAltFireWeapon_Validate(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey)
+{
+	return !TraceStart.ContainsNaN() && !Direction.ContainsNaN();
+}
+
+void AGGTCharacter::ServerAltFireWeapon_Implementation(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey)
+{
+	if (EquippedWeapon == nullptr)
+	{
+		SendWeaponAck(PredictionKey, false);
+		return;
+	}
+
+	ValidateClientTrace(TraceStart, Direction);
+
+	// Aim the weapon the way the client aimed, the muzzle decides where the object is launched and held
+	CameraComponent->SetWorldRotation(Direction.Rotation());
+
+	// Alt fire the weapon against the world as the client saw it
+	EquippedWeapon->SetFireRewindTime(ClientTime);
+	EquippedWeapon->AltFire(TraceStart, Direction);
+	EquippedWeapon->SetFireRewindTime(-1.0f);
+
+	// Alt fire has no cooldown, the held object is all the client can get wrong
+	SendWeaponAck(PredictionKey, true);
+}
+
+void AGGTCharacter::SendWeaponAck(int32 PredictionKey, bool bAccepted)
+{
+	UPrimitiveComponent* HeldComponent = nullptr;
+	bool bPulling = false;
+	float FireDelay = 0.0f;
+
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->GetHeldObject(HeldComponent, bPulling);
+		FireDelay = EquippedWeapon->GetFireDelay();
+	}
+
+	ClientAckWeaponAction(PredictionKey, bAccepted, FireDelay, HeldComponent, bPulling, WeaponSlots, ActiveWeaponSlot);
+}
+
+int32 AGGTCharacter::BeginPrediction(AWeaponBase* PredictedWeapon)
+{
+	LastPredictionKey++;
+	PredictionSendTimes[LastPredictionKey % PredictionSendTimes.Num()] = GetWorld()->GetRealTimeSeconds();
+	PredictionWeapons[LastPredictionKey % PredictionWeapons.Num()] = PredictedWeapon;
+	PredictionStats.Actions++;
+
+	return LastPredictionKey;
+}
+
+void AGGTCharacter::ClientAckWeaponAction_Implementation(int32 PredictionKey, bool bAccepted, float ServerFireDelay, UPrimitiveComponent* ServerComponent, bool bServerPulling, const TArray<AWeaponBase*>& ServerWeaponSlots, int32 ServerActiveSlot)
+{
+	const float RoundTrip = GetWorld()->GetRealTimeSeconds() - PredictionSendTimes[PredictionKey % PredictionSendTimes.Num()];
+	PredictionStats.Acks++;
+	PredictionStats.TotalRoundTrip += RoundTrip;
+	PredictionStats.MaxRoundTrip = FMath::Max(PredictionStats.MaxRoundTrip, RoundTrip);
+
+	LastAckedPredictionKey = FMath::Max(LastAckedPredictionKey, PredictionKey);
+	if (PendingInventoryKey != 0 && PredictionKey >= PendingInventoryKey)
+		PendingInventoryKey = 0;
+
+	// The server did the action with another weapon than the client, for example after a switch the server refused
+	AWeaponBase* ServerWeapon = ServerWeaponSlots.IsValidIndex(ServerActiveSlot) ? ServerWeaponSlots[ServerActiveSlot] : nullptr;
+	AWeaponBase* PredictedWeapon = PredictionWeapons[PredictionKey % PredictionWeapons.Num()].Get();
+	if (PredictedWeapon && PredictedWeapon != ServerWeapon)
+		PredictionStats.WeaponMismatches++;
+
+	// A refused fire means the server had a cooldown the client didn't know about, wait out what is left of it.
+	// The server sent its cooldown half a round trip ago.
+	if (!bAccepted)
+	{
+		PredictionStats.Rejected++;
+		if (EquippedWeapon)
+			EquippedWeapon->SetFireDelay(FMath::Max(ServerFireDelay - (RoundTrip * 0.5f), EquippedWeapon->GetFireDelay()));
+	}
+
+	// Newer actions are still on their way to the server, this older state would undo what they predicted
+	if (PredictionKey != LastPredictionKey)
+		return;
+
+	// Carry the same weapons as the server before correcting what the equipped one holds
+	if (WeaponSlots != ServerWeaponSlots || ActiveWeaponSlot != ServerActiveSlot)
+	{
+		WeaponSlots = ServerWeaponSlots;
+		ActiveWeaponSlot = ServerActiveSlot;
+		ApplyWeaponSlots();
+		PredictionStats.WeaponCorrections++;
+	}
+
+	if (EquippedWeapon && EquippedWeapon->ReconcileHeldObject(ServerComponent, bServerPulling))
+		PredictionStats.Corrections++;
+}
+
+void AGGTCharacter::ResetPredictionStats()
+{
+	PredictionStats = FGGTPredictionStats();
+}
+
+void AGGTCharacter::UpdateAimRotation()
+{
+	// The control rotation on the server and for bots, the replicated view pitch on other clients
+	CameraComponent->SetWorldRotation(GetBaseAimRotation());
+}
+
+void AGGTCharacter::ValidateClientTrace(FVector& TraceStart, FVector& Direction) const
+{
+	// The client can't fire from somewhere the character isn't
+	const FVector CameraLocation = CameraComponent->GetComponentLocation();
+	if (FVector::DistSquared(TraceStart, CameraLocation) > FMath::Square(MaxTraceStartError))
+		TraceStart = CameraLocation;
+
+	Direction = Direction.GetSafeNormal();
+	if (Direction.IsZero())
+		Direction = CameraComponent->GetForwardVector();
+}
+
 void AGGTCharacter::DropWeapon()
 {
 	if (EquippedWeapon == nullptr)
 		return;
+
+	// The server owns the weapons, the dropped weapon and the new slots come back from it
+	if (Role < ROLE_Authority)
+	{
+		PendingInventoryKey = BeginPrediction(nullptr);
+		ServerDropWeapon(PendingInventoryKey);
+		return;
+	}
 	
+	UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Drop, EquippedWeapon, nullptr, ActiveWeaponSlot);
+
 	// Let the weapon know it's being dropped
 	EquippedWeapon->DropWeapon();
+	EquippedWeapon->SetHolder(nullptr);
 
 	// Detaches, sets the state and removes the reference to the equipped weapon.
 	EquippedWeapon->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
 	EquippedWeapon->SetState(EWeaponStates::WS_Free);
 	EquippedWeapon->WeaponMesh->AddImpulse((FVector::UpVector + FVector(0.0f, 0.5f, 0.0f)) * 2000.0f);
 	EquippedWeapon = nullptr;
+	EquippedTargeting = FWeaponTargetingInfo();
+
+	// Free the slot and switch to the next weapon that is carried, if there is any
+	const int32 DroppedSlot = ActiveWeaponSlot;
+	if (WeaponSlots.IsValidIndex(DroppedSlot))
+		WeaponSlots[DroppedSlot] = nullptr;
+	ActiveWeaponSlot = INDEX_NONE;
+
+	SelectWeaponSlot(FindOccupiedSlot(DroppedSlot, 1));
 }
 
 void AGGTCharacter::EquipWeapon(AWeaponBase* NewWeapon)
@@ -149,14 +410,224 @@ void AGGTCharacter::EquipWeapon(AWeaponBase* NewWeapon)
 	if (NewWeapon == nullptr)
 		return;
 
-	// Drop the weapon if there is one equipped
-	if (EquippedWeapon)
+	// If the weapon is already carried, just switch to it
+	int32 Slot = WeaponSlots.Find(NewWeapon);
+	if (Slot != INDEX_NONE)
+	{
+		SelectWeaponSlot(Slot);
+		return;
+	}
+
+	// Only the server picks up weapons, so two players can't both take the same one
+	if (Role < ROLE_Authority)
+	{
+		PendingInventoryKey = BeginPrediction(nullptr);
+		ServerEquipWeapon(NewWeapon, PendingInventoryKey);
+		return;
+	}
+
+	// Find a free slot, and if there is none drop the equipped weapon to make room for the new one
+	Slot = WeaponSlots.Find(nullptr);
+	if (Slot == INDEX_NONE)
+	{
+		Slot = ActiveWeaponSlot;
 		DropWeapon();
+	}
 
-	// Set the reference
-	EquippedWeapon = NewWeapon;
-	EquippedWeapon->SetState(EWeaponStates::WS_Held);
+	// The collision and physics of the weapon is only changed here, it stays held while it's in the inventory
+	WeaponSlots[Slot] = NewWeapon;
+	NewWeapon->SetHolder(this);
+	NewWeapon->SetState(EWeaponStates::WS_Held);
 	
 	// Attach gun mesh component to the player mesh
-	EquippedWeapon->AttachToComponent(PlayerMesh, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+	NewWeapon->AttachToComponent(PlayerMesh, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+
+	UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Equip, NewWeapon, nullptr, Slot);
+
+	// Start out hidden and let the slot selection show it
+	NewWeapon->SetWeaponActive(false);
+	SelectWeaponSlot(Slot);
+}
+
+void AGGTCharacter::RefreshPickupCandidates()
+{
+	PickupRefreshTime = GetWorld()->GetTimeSeconds();
+	PickupCandidates.Reset();
+
+	// One query around the character, instead of an overlap sphere on every weapon lying around
+	TArray<FOverlapResult> Overlaps;
+	const FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::AllDynamicObjects);
+	GetWorld()->OverlapMultiByObjectType(Overlaps, GetActorLocation(), FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(PickupRadius));
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AWeaponBase* Weapon = Cast<AWeaponBase>(Overlap.GetActor());
+		if (Weapon && Weapon->GetState() == EWeaponStates::WS_Free)
+			PickupCandidates.AddUnique(Weapon);
+	}
+}
+
+AWeaponBase* AGGTCharacter::FindPickupCandidate(float MaxDistance) const
+{
+	const FVector ViewLocation = CameraComponent->GetComponentLocation();
+	const FVector ViewDirection = CameraComponent->GetForwardVector();
+	const float MinDot = FMath::Cos(FMath::DegreesToRadians(PickupViewAngle));
+
+	AWeaponBase* BestWeapon = nullptr;
+	float BestDot = MinDot;
+
+	// Score the candidates by how close they are to the center of the view
+	for (AWeaponBase* Weapon : PickupCandidates)
+	{
+		// Weapons that were picked up by someone else might not have left the list yet
+		if (Weapon == nullptr || Weapon->IsPendingKill() || Weapon->GetState() != EWeaponStates::WS_Free)
+			continue;
+
+		const FVector ToWeapon = Weapon->WeaponMesh->GetComponentLocation() - ViewLocation;
+		const float DistanceSquared = ToWeapon.SizeSquared();
+		if (DistanceSquared > FMath::Square(MaxDistance))
+			continue;
+
+		const float Dot = FVector::DotProduct(ToWeapon * FMath::InvSqrt(FMath::Max(DistanceSquared, KINDA_SMALL_NUMBER)), ViewDirection);
+		if (Dot >= BestDot)
+		{
+			BestDot = Dot;
+			BestWeapon = Weapon;
+		}
+	}
+
+	return BestWeapon;
+}
+
+bool AGGTCharacter::SelectWeaponSlot(int32 Slot)
+{
+	if (!WeaponSlots.IsValidIndex(Slot) || WeaponSlots[Slot] == nullptr || Slot == ActiveWeaponSlot)
+		return false;
+
+	// Put away the current weapon, it stays attached so only visibility and ticking changes
+	if (EquippedWeapon)
+		EquippedWeapon->SetWeaponActive(false);
+
+	// Set the reference
+	ActiveWeaponSlot = Slot;
+	EquippedWeapon = WeaponSlots[Slot];
+	EquippedWeapon->SetWeaponActive(true);
+
+	// Ask the weapon once what it needs every frame
+	EquippedTargeting = EquippedWeapon->GetTargetingInfo();
+
+	// Load the assets of the weapon the player is most likely to switch to next
+	const int32 NextSlot = FindOccupiedSlot(Slot, 1);
+	if (NextSlot != INDEX_NONE && NextSlot != Slot)
+		WeaponSlots[NextSlot]->PrefetchAssets();
+
+	// Remote clients switched their own slots right away, let the server switch as well
+	if (Role < ROLE_Authority)
+		ServerSelectWeaponSlot(Slot, BeginPrediction(EquippedWeapon));
+
+	return true;
+}
+
+bool AGGTCharacter::ServerEquipWeapon_Validate(AWeaponBase* NewWeapon, int32 PredictionKey)
+{
+	return true;
+}
+
+void AGGTCharacter::ServerEquipWeapon_Implementation(AWeaponBase* NewWeapon, int32 PredictionKey)
+{
+	// Only free weapons the character is standing next to, the answer tells the client if it got it
+	RefreshPickupCandidates();
+	if (NewWeapon && NewWeapon->GetState() == EWeaponStates::WS_Free && PickupCandidates.Contains(NewWeapon))
+		EquipWeapon(NewWeapon);
+
+	SendWeaponAck(PredictionKey, true);
+}
+
+bool AGGTCharacter::ServerDropWeapon_Validate(int32 PredictionKey)
+{
+	return true;
+}
+
+void AGGTCharacter::ServerDropWeapon_Implementation(int32 PredictionKey)
+{
+	DropWeapon();
+	SendWeaponAck(PredictionKey, true);
+}
+
+bool AGGTCharacter::ServerSelectWeaponSlot_Validate(int32 Slot, int32 PredictionKey)
+{
+	return true;
+}
+
+void AGGTCharacter::ServerSelectWeaponSlot_Implementation(int32 Slot, int32 PredictionKey)
+{
+	SelectWeaponSlot(Slot);
+	SendWeaponAck(PredictionKey, true);
+}
+
+void AGGTCharacter::ApplyWeaponSlots()
+{
+	AWeaponBase* NewWeapon = WeaponSlots.IsValidIndex(ActiveWeaponSlot) ? WeaponSlots[ActiveWeaponSlot] : nullptr;
+
+	// Only the carried weapons are hidden, a weapon that was dropped is shown by the server
+	for (AWeaponBase* Weapon : WeaponSlots)
+	{
+		if (Weapon && Weapon != NewWeapon)
+			Weapon->SetWeaponActive(false);
+	}
+
+	EquippedWeapon = NewWeapon;
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetWeaponActive(true);
+		EquippedTargeting = EquippedWeapon->GetTargetingInfo();
+	}
+	else
+	{
+		EquippedTargeting = FWeaponTargetingInfo();
+	}
+}
+
+void AGGTCharacter::OnRep_WeaponSlots()
+{
+	// The owning client guesses its own switches, the slots the server replicated may be older than what it guessed.
+	// Keep the guess until the answer to the last action brings the slots, and only fix the slot index to the equipped weapon.
+	if (IsLocallyControlled() && LastAckedPredictionKey != LastPredictionKey)
+	{
+		const int32 EquippedSlot = WeaponSlots.Find(EquippedWeapon);
+		if (EquippedSlot != INDEX_NONE)
+		{
+			ActiveWeaponSlot = EquippedSlot;
+			return;
+		}
+	}
+
+	ApplyWeaponSlots();
+}
+
+bool AGGTCharacter::NextWeapon()
+{
+	return SelectWeaponSlot(FindOccupiedSlot(ActiveWeaponSlot, 1));
+}
+
+bool AGGTCharacter::PreviousWeapon()
+{
+	return SelectWeaponSlot(FindOccupiedSlot(ActiveWeaponSlot, -1));
+}
+
+int32 AGGTCharacter::FindOccupiedSlot(int32 StartSlot, int32 Direction) const
+{
+	const int32 NumSlots = WeaponSlots.Num();
+	if (NumSlots == 0)
+		return INDEX_NONE;
+
+	// Go through every other slot once, wrapping around, and end on the start slot
+	for (int32 i = 1; i <= NumSlots; i++)
+	{
+		const int32 Slot = (((StartSlot + (i * Direction)) % NumSlots) + NumSlots) % NumSlots;
+		if (WeaponSlots[Slot])
+			return Slot;
+	}
+
+	return INDEX_NONE;
 }
\ No newline at end of file
@@ -11,6 +11,39 @@
 class AGGTPlayerController;
 
 
+/** How the predicted weapon actions of the owning client went, since the stats were last reset */
+struct FGGTPredictionStats
+{
+	/** Actions the client predicted and sent, and the answers it got back */
+	int32 Actions;
+	int32 Acks;
+
+	/** Fires the server refused, and answers where the client held something else than the server */
+	int32 Rejected;
+	int32 Corrections;
+
+	/** Answers where the server used another weapon than the client guessed, and where the client had to take over the slots of the server */
+	int32 WeaponMismatches;
+	int32 WeaponCorrections;
+
+	/** Seconds between sending an action and getting the answer */
+	float TotalRoundTrip;
+	float MaxRoundTrip;
+
+	FGGTPredictionStats()
+		: Actions(0)
+		, Acks(0)
+		, Rejected(0)
+		, Corrections(0)
+		, WeaponMismatches(0)
+		, WeaponCorrections(0)
+		, TotalRoundTrip(0.0f)
+		, MaxRoundTrip(0.0f)
+	{
+	}
+};
+
+
 UCLASS()
 class GRAVITYGUNTEST_API AGGTCharacter : public ACharacter
 {
@@ -37,25 +70,98 @@ class GRAVITYGUNTEST_API AGGTCharacter : public ACharacter
 		UFUNCTION(BlueprintCallable, Category = "Weapon")
 		bool AltFireWeapon();
 
-		/** Drops the currently equiped weapon on the floor */
+		/** Turns the object held by the weapon, if the weapon can */
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		void RotateHeldObject(float Yaw, float Pitch);
+
+		/** Drops the currently equiped weapon on the floor.
+		*	The server owns the weapons, a remote client asks the server and gets the new slots in its answer.
+		*/
 		UFUNCTION(BlueprintCallable, Category = "Weapon")
 		void DropWeapon();
 
-		/** Equips the provided weapon */
+		/** Equips the provided weapon.
+		*	The weapon is put in a free inventory slot, if all slots are taken the current weapon is dropped to make room.
+		*	A remote client asks the server to pick the weapon up, switching to a weapon it already carries is guessed like SelectWeaponSlot.
+		*/
 		UFUNCTION(BlueprintCallable, Category = "Weapon")
 		void EquipWeapon(AWeaponBase* NewWeapon);
 
+		/** Finds the free weapons within PickupRadius with one overlap query, so dropped weapons don't need a component of their own for it.
+		*	The crosshair refreshes the list every PickupRefreshInterval, picking up refreshes it right away.
+		*/
+		void RefreshPickupCandidates();
+
+		/** Get the nearby free weapon the player is looking most directly at, nullptr if there is none within MaxDistance and PickupViewAngle */
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		AWeaponBase* FindPickupCandidate(float MaxDistance) const;
+
+		/** Switches to the weapon in the provided slot, returns false if the slot is empty or already active.
+		*	A remote client switches right away and lets the server switch as well, the answer of the server corrects it.
+		*/
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		bool SelectWeaponSlot(int32 Slot);
+
+		/** Switches to the next/previous slot that has a weapon in it */
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		bool NextWeapon();
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		bool PreviousWeapon();
+
 
 		/** A reference to the currently equipped weapon, if there is any */
 		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
 		AWeaponBase* EquippedWeapon;
 
+		/** How many weapons the character can carry at the same time */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "1"))
+		int32 WeaponSlotCount;
+
+		/** The carried weapons. The weapons stay attached to the character and the ones that are not active are hidden.
+		*	Empty slots are nullptr. Set by the server, see OnRep_WeaponSlots.
+		*/
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_WeaponSlots, Category = "Weapon")
+		TArray<AWeaponBase*> WeaponSlots;
+
+		/** The slot of the equipped weapon, INDEX_NONE if no weapon is equipped */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_WeaponSlots, Category = "Weapon")
+		int32 ActiveWeaponSlot;
+
 		/** A reference to the weapon class that the player character should start the game holding.
 		*	Leave empty to start the game without a weapon equipped.
 		*/
 		UPROPERTY(EditDefaultsOnly, Category = "Weapon")
 		TSubclassOf<AWeaponBase> StartWeaponClass;
 
+		/** How close a free weapon has to be to become a pickup candidate, free weapons need a dynamic object type to be found */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "0.0"))
+		float PickupRadius;
+
+		/** Seconds between two refreshes of the pickup candidates for the crosshair */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "0.0"))
+		float PickupRefreshInterval;
+
+		/** How many degrees away from the view direction a weapon can be and still be picked up */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+		float PickupViewAngle;
+
+		/** How far the trace start sent by a remote client may be from the camera on the server before it's replaced by the camera location */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+		float MaxTraceStartError;
+
+		/** How much cooldown the server may have left when a fire of a remote client arrives and still accept it.
+		*	The client counts its cooldown from when it fired, the server from when the fire arrived, so jitter can make a fire arrive a little early.
+		*/
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "0.0"))
+		float MaxFireDelayTolerance;
+
+		/** Get the prediction stats of the owning client */
+		const FGGTPredictionStats& GetPredictionStats() const { return PredictionStats; }
+		void ResetPredictionStats();
+
+		/** Replicates the weapon slots */
+		virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 
 	private:
 
@@ -64,8 +170,97 @@ class GRAVITYGUNTEST_API AGGTCharacter : public ACharacter
 
 	protected:
 
-		/** Trace parameters for the line trace used for interaction and crosshair alert traces */
-		FCollisionQueryParams TraceParams;
+		/** Trace parameters for the line trace used for the crosshair alert trace, shared by all characters */
+		static const FCollisionQueryParams& GetHoverTraceParams();
+
+		/** What the equipped weapon needs every frame, copied from the weapon when it's equipped */
+		FWeaponTargetingInfo EquippedTargeting;
+
+		/** Free weapons within PickupRadius when the candidates were last refreshed, and when that was */
+		UPROPERTY()
+		TArray<AWeaponBase*> PickupCandidates;
+		float PickupRefreshTime;
+
+		/** Fires the weapon on the server for a remote client, which already fired its own copy of the weapon.
+		*	ClientTime is the server world time the client saw when it fired, the server traces the props as they were at that time.
+		*	The server answers with ClientAckWeaponAction and the same prediction key.
+		*/
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerFireWeapon(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey);
+
+		/** Alt fires the weapon on the server for a remote client, see ServerFireWeapon */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerAltFireWeapon(FVector TraceStart, FVector Direction, float ClientTime, int32 PredictionKey);
+
+		/** Picks up the weapon on the server for a remote client, if the character is next to it */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerEquipWeapon(AWeaponBase* NewWeapon, int32 PredictionKey);
+
+		/** Drops the equipped weapon on the server for a remote client */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerDropWeapon(int32 PredictionKey);
+
+		/** Switches the weapon on the server for a remote client, which already switched its own slots */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerSelectWeaponSlot(int32 Slot, int32 PredictionKey);
+
+		/** The answer of the server to a predicted action: if a fire was accepted, the cooldown and what the weapon holds after it,
+		*	and the weapon slots of the server. Weapon changes are always accepted, what the server ended up with is in the slots.
+		*	The client corrects its slots and its copy of the weapon if it guessed wrong.
+		*/
+		UFUNCTION(Client, Reliable)
+		void ClientAckWeaponAction(int32 PredictionKey, bool bAccepted, float ServerFireDelay, UPrimitiveComponent* ServerComponent, bool bServerPulling, const TArray<AWeaponBase*>& ServerWeaponSlots, int32 ServerActiveSlot);
+
+		/** Sends the state of the equipped weapon and the slots to the owning client */
+		void SendWeaponAck(int32 PredictionKey, bool bAccepted);
+
+		/** Starts a predicted action on the owning client, returns its key.
+		*	PredictedWeapon is the weapon the client used for the action, nullptr if the client didn't guess the result.
+		*/
+		int32 BeginPrediction(AWeaponBase* PredictedWeapon);
+
+		/** The key of the last action the client sent, older answers don't touch the slots or the held object */
+		int32 LastPredictionKey;
+
+		/** The key of the last action the server answered */
+		int32 LastAckedPredictionKey;
+
+		/** The key of a pickup or drop that is on its way to the server, 0 if there is none.
+		*	The client can't guess those, so until the answer arrives weapon actions are only done by the server.
+		*/
+		int32 PendingInventoryKey;
+
+		/** When the last few actions were sent and the weapon they were guessed with, by key */
+		TArray<float> PredictionSendTimes;
+		TArray<TWeakObjectPtr<AWeaponBase>> PredictionWeapons;
+
+		FGGTPredictionStats PredictionStats;
+
+		/** Turns the held object on the server for a remote client, sent every frame the input changes so it's unreliable */
+		UFUNCTION(Server, Unreliable, WithValidation)
+		void ServerRotateHeldObject(float Yaw, float Pitch);
+
+		/** Turns the camera, and with it the arms and the weapon, to the aim rotation of the character.
+		*	The camera only follows the control rotation by itself when it's the view of a local player,
+		*	so on the server, for bots and for other players the weapon would keep pointing the way it did when it was spawned.
+		*/
+		void UpdateAimRotation();
+
+		/** Makes sure the trace sent by a remote client starts close to where the character actually is */
+		void ValidateClientTrace(FVector& TraceStart, FVector& Direction) const;
+
+		/** Shows the weapon in the active slot and hides the other carried ones, used when the slots come from the server */
+		void ApplyWeaponSlots();
+
+		/** Applies the slots the server replicated, the owning client waits for the answer to its last action instead */
+		UFUNCTION()
+		void OnRep_WeaponSlots();
+
+		/** Finds the next slot with a weapon in it, in the provided direction. Returns INDEX_NONE if there is none. */
+		int32 FindOccupiedSlot(int32 StartSlot, int32 Direction) const;
+
+		/** Shows the interact alert and pickup text on the widget when looking at something usable, runs once per frame */
+		void UpdateCrosshair();
 
 		/** Called when the game starts or when spawned */
 		virtual void BeginPlay() override;
@@ -3,11 +3,22 @@
 #include "GravityGunTest.h"
 #include "GGTPlayerController.h"
 
+#include "General/GGTCheatManager.h"
+#include "General/GGTGameState.h"
+#include "General/GGTRewindBuffer.h"
 
 AGGTPlayerController::AGGTPlayerController()
 {
+	// Use the cheat manager with the weapon system test commands
+	CheatClass = UGGTCheatManager::StaticClass();
 
 	InteractTraceLength = 300.0f;
+	bRotatingHeld = false;
+
+	RewindTestTraces = 0;
+	RewindTestCurrentHits = 0;
+	RewindTestRewindHits = 0;
+	RewindTestSeconds = 0.0;
 }
 
 // Called to bind functionality to input
@@ -31,11 +42,19 @@ void AGGTPlayerController::SetupInputComponent()
 	InputComponent->BindAction("Interact", IE_Pressed, this, &AGGTPlayerController::Interact);
 
 	// Player mouse movement
-	InputComponent->BindAxis("Turn", this, &APlayerController::AddYawInput);
-	InputComponent->BindAxis("LookUp", this, &APlayerController::AddPitchInput);
+	InputComponent->BindAxis("Turn", this, &AGGTPlayerController::Turn);
+	InputComponent->BindAxis("LookUp", this, &AGGTPlayerController::LookUp);
+
+	// Turning the held object
+	InputComponent->BindAction("RotateHeld", IE_Pressed, this, &AGGTPlayerController::StartRotateHeld);
+	InputComponent->BindAction("RotateHeld", IE_Released, this, &AGGTPlayerController::StopRotateHeld);
 
 	// Weapon drop
 	InputComponent->BindAction("DropWeapon", IE_Pressed, this, &AGGTPlayerController::DropWeapon);
+
+	// Weapon switching
+	InputComponent->BindAction("NextWeapon", IE_Pressed, this, &AGGTPlayerController::NextWeapon);
+	InputComponent->BindAction("PreviousWeapon", IE_Pressed, this, &AGGTPlayerController::PreviousWeapon);
 }
 
 void AGGTPlayerController::BeginPlay()
@@ -66,6 +85,32 @@ void AGGTPlayerController::Tick(float DeltaTime)
 
 }
 
+void AGGTPlayerController::Turn(float Value)
+{
+	if (bRotatingHeld && ControlledCharacter)
+		ControlledCharacter->RotateHeldObject(Value, 0.0f);
+	else
+		AddYawInput(Value);
+}
+
+void AGGTPlayerController::LookUp(float Value)
+{
+	if (bRotatingHeld && ControlledCharacter)
+		ControlledCharacter->RotateHeldObject(0.0f, Value);
+	else
+		AddPitchInput(Value);
+}
+
+void AGGTPlayerController::StartRotateHeld()
+{
+	bRotatingHeld = true;
+}
+
+void AGGTPlayerController::StopRotateHeld()
+{
+	bRotatingHeld = false;
+}
+
 void AGGTPlayerController::LeftClick()
 {
 	if (ControlledCharacter == nullptr)
@@ -127,28 +172,13 @@ void AGGTPlayerController::Interact()
 	if (ControlledCharacter == nullptr)
 		return;
 
-	// Perform a line trace to see if something was hit that can be interacted with
-	FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Interct Trace")), false, nullptr);
-	TraceParams.bReturnPhysicalMaterial = false;
-	TraceParams.bTraceComplex = false;
-
-	FHitResult hitResult(ForceInit);
-	FVector startFVector = ControlledCharacter->CameraComponent->GetComponentLocation();
-	FVector endFVector = startFVector + (ControlledCharacter->CameraComponent->GetForwardVector() * InteractTraceLength);
-
-	if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, TraceParams))
+	// Pick up the free weapon nearby that the player is looking at
+	ControlledCharacter->RefreshPickupCandidates();
+	AWeaponBase* Weapon = ControlledCharacter->FindPickupCandidate(InteractTraceLength);
+	if (Weapon)
 	{
-		// Check if the hit object is a weapon by checking tag
-		if (hitResult.GetComponent()->ComponentHasTag("Weapon"))
-		{
-			// Make sure that the weapon is free
-			AWeaponBase* Weapon = Cast<AWeaponBase>(hitResult.GetActor());
-			if (Weapon && Weapon->GetState() == EWeaponStates::WS_Free)
-			{
-				// Then tell the character to equip the weapon
-				ControlledCharacter->EquipWeapon(Weapon);
-			}
-		}
+		// Then tell the character to equip the weapon, on a remote client the character asks the server for it
+		ControlledCharacter->EquipWeapon(Weapon);
 	}
 }
 
@@ -159,4 +189,77 @@ void AGGTPlayerController::DropWeapon()
 
 	// Tell the character to drop the currently equipped weapon
 	ControlledCharacter->DropWeapon();
-}
\ No newline at end of file
+}
+
+void AGGTPlayerController::NextWeapon()
+{
+	if (ControlledCharacter == nullptr)
+		return;
+
+	// Switch to the next carried weapon
+	ControlledCharacter->NextWeapon();
+}
+
+void AGGTPlayerController::PreviousWeapon()
+{
+	if (ControlledCharacter == nullptr)
+		return;
+
+	// Switch to the previous carried weapon
+	ControlledCharacter->PreviousWeapon();
+}
+
+bool AGGTPlayerController::ServerRewindTestTrace_Validate(FVector TraceStart, FVector TraceEnd, float ClientTime, UPrimitiveComponent* Target)
+{
+	return !TraceStart.ContainsNaN() && !TraceEnd.ContainsNaN();
+}
+
+void AGGTPlayerController::ServerRewindTestTrace_Implementation(FVector TraceStart, FVector TraceEnd, float ClientTime, UPrimitiveComponent* Target)
+{
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (Target == nullptr || GameState == nullptr || GameState->RewindBuffer == nullptr)
+		return;
+
+	RewindTestTraces++;
+
+	// Without rewinding, the trace is done against the current world
+	FCollisionQueryParams TraceParams(FName(TEXT("Rewind Test")), false, GetPawn());
+	FHitResult hitResult(ForceInit);
+	if (GetWorld()->LineTraceSingleByChannel(hitResult, TraceStart, TraceEnd, ECC_Visibility, TraceParams) && hitResult.GetComponent() == Target)
+		RewindTestCurrentHits++;
+
+	// With rewinding, the way a fire of a remote client is traced
+	FGGTRewindHit RewindHit;
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bRewindHit = GameState->RewindBuffer->RewindLineTrace(TraceStart, TraceEnd, ClientTime, RewindHit);
+	RewindTestSeconds += FPlatformTime::Seconds() - StartTime;
+
+	if (bRewindHit && RewindHit.Component == Target)
+		RewindTestRewindHits++;
+}
+
+bool AGGTPlayerController::ServerRewindTestReport_Validate()
+{
+	return true;
+}
+
+void AGGTPlayerController::ServerRewindTestReport_Implementation()
+{
+	const float MicrosecondsPerTrace = RewindTestTraces > 0 ? (float)((RewindTestSeconds * 1000000.0) / RewindTestTraces) : 0.0f;
+
+	UE_LOG(LogTemp, Log, TEXT("GGTRewindTest: %s, %d traces, hit accuracy without rewind %.1f%%, with rewind %.1f%%, %.2f us per rewind trace"),
+		*GetName(), RewindTestTraces, 100.0f * RewindTestCurrentHits / FMath::Max(RewindTestTraces, 1), 100.0f * RewindTestRewindHits / FMath::Max(RewindTestTraces, 1), MicrosecondsPerTrace);
+
+	ClientRewindTestReport(RewindTestTraces, RewindTestCurrentHits, RewindTestRewindHits, MicrosecondsPerTrace);
+
+	RewindTestTraces = 0;
+	RewindTestCurrentHits = 0;
+	RewindTestRewindHits = 0;
+	RewindTestSeconds = 0.0;
+}
+
+void AGGTPlayerController::ClientRewindTestReport_Implementation(int32 NumTraces, int32 CurrentHits, int32 RewindHits, float MicrosecondsPerTrace)
+{
+	UE_LOG(LogTemp, Log, TEXT("GGTRewindTest: %d traces reached the server, hit accuracy without rewind %.1f%%, with rewind %.1f%%, %.2f us per rewind trace"),
+		NumTraces, 100.0f * CurrentHits / FMath::Max(NumTraces, 1), 100.0f * RewindHits / FMath::Max(NumTraces, 1), MicrosecondsPerTrace);
+}
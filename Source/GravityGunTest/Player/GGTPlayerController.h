@@ -35,12 +35,31 @@ class GRAVITYGUNTEST_API AGGTPlayerController : public APlayerController
 		UMainWidget* MainWidget;
 
 
+		/** One trace of GGTRewindTest, traced on the server against the current world and the rewound props */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerRewindTestTrace(FVector TraceStart, FVector TraceEnd, float ClientTime, UPrimitiveComponent* Target);
+
+		/** Logs the results of the GGTRewindTest traces on the server and sends them to the client */
+		UFUNCTION(Server, Reliable, WithValidation)
+		void ServerRewindTestReport();
+
+		/** Logs the results of GGTRewindTest on the client */
+		UFUNCTION(Client, Reliable)
+		void ClientRewindTestReport(int32 NumTraces, int32 CurrentHits, int32 RewindHits, float MicrosecondsPerTrace);
+
+
 	private:
 		
 		/** The character controlled by this controller */
 		UPROPERTY()
 		AGGTCharacter* ControlledCharacter;
 
+		/** Results of the GGTRewindTest traces since the last report */
+		int32 RewindTestTraces;
+		int32 RewindTestCurrentHits;
+		int32 RewindTestRewindHits;
+		double RewindTestSeconds;
+
 
 	protected:
 
@@ -56,10 +75,23 @@ class GRAVITYGUNTEST_API AGGTPlayerController : public APlayerController
 		void Jump();
 		void StopJumping();
 
+		/** Called for mouse movement, turns the held object instead of the view while the rotate key is held */
+		void Turn(float Value);
+		void LookUp(float Value);
+
+		/** Called when the player presses and releases the key that turns the held object */
+		void StartRotateHeld();
+		void StopRotateHeld();
+
+		/** If the mouse turns the held object instead of the view */
+		bool bRotatingHeld;
+
 		void LeftClick();
 		void RightClick();
 		void Interact();
 		void DropWeapon();
+		void NextWeapon();
+		void PreviousWeapon();
 
 		/** Called to bind functionality to input */
 		virtual void SetupInputComponent() override;
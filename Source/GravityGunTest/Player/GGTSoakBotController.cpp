@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTSoakBotController.h"
+
+#include "GGTCharacter.h"
+#include "Weapons/GravityGun.h"
+
+
+AGGTSoakBotController::AGGTSoakBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bWantsPlayerState = false;
+
+	MinThinkInterval = 0.2f;
+	MaxThinkInterval = 1.0f;
+	TargetSearchRadius = 1500.0f;
+
+	ThinkTimer = 0.0f;
+	GrabAttempts = 0;
+	Grabs = 0;
+}
+
+void AGGTSoakBotController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Random.Initialize(GetTypeHash(GetFName()));
+	ThinkTimer = Random.FRandRange(MinThinkInterval, MaxThinkInterval);
+}
+
+void AGGTSoakBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AGGTCharacter* Character = Cast<AGGTCharacter>(GetPawn());
+	if (Character == nullptr)
+		return;
+
+	ThinkTimer -= DeltaTime;
+	if (ThinkTimer > 0.0f)
+		return;
+
+	ThinkTimer = Random.FRandRange(MinThinkInterval, MaxThinkInterval);
+	Think(Character);
+}
+
+void AGGTSoakBotController::Think(AGGTCharacter* Character)
+{
+	// Pick the weapon up again first, so the bot spends most of its time holding one
+	if (Character->EquippedWeapon == nullptr)
+	{
+		AWeaponBase* Weapon = DroppedWeapon.Get();
+		if (Weapon && Weapon->GetState() == EWeaponStates::WS_Free)
+			Character->EquipWeapon(Weapon);
+
+		DroppedWeapon.Reset();
+		return;
+	}
+
+	const float Roll = Random.FRand();
+
+	if (Roll < 0.45f)
+	{
+		// Grab, or let go if something is already held
+		if (AimAtRandomTarget(Character))
+		{
+			UPrimitiveComponent* HeldComp = nullptr;
+			bool bPulling = false;
+			Character->EquippedWeapon->GetHeldObject(HeldComp, bPulling);
+			const bool bWasHolding = HeldComp != nullptr;
+
+			Character->AltFireWeapon();
+
+			// Count the grab if the gun holds or pulls something now, a bot that can't aim would never catch anything
+			if (!bWasHolding && Character->EquippedWeapon)
+			{
+				GrabAttempts++;
+				Character->EquippedWeapon->GetHeldObject(HeldComp, bPulling);
+				if (HeldComp)
+					Grabs++;
+			}
+		}
+	}
+	else if (Roll < 0.85f)
+	{
+		// Fire, at whatever is held or in front of the view
+		AimAtRandomTarget(Character);
+		Character->FireWeapon();
+	}
+	else if (Roll < 0.95f)
+	{
+		// Drop while holding something, this is where orphaned grabs would show up
+		DroppedWeapon = Character->EquippedWeapon;
+		Character->DropWeapon();
+	}
+	else
+	{
+		// Switch between carried weapons
+		Character->NextWeapon();
+	}
+}
+
+bool AGGTSoakBotController::AimAtRandomTarget(AGGTCharacter* Character)
+{
+	const FVector ViewLocation = Character->CameraComponent->GetComponentLocation();
+
+	TArray<FOverlapResult> Overlaps;
+	FCollisionObjectQueryParams ObjectParams(ECC_PhysicsBody);
+	FCollisionQueryParams QueryParams(FName(TEXT("Soak Bot Target")), false, Character);
+	GetWorld()->OverlapMultiByObjectType(Overlaps, ViewLocation, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(TargetSearchRadius), QueryParams);
+
+	// Only aim at objects the gravity gun can grab
+	Overlaps.RemoveAllSwap([](const FOverlapResult& Overlap) { return !AGravityGun::IsGrabbable(Overlap.GetComponent()); });
+	if (Overlaps.Num() == 0)
+		return false;
+
+	const FVector Target = Overlaps[Random.RandHelper(Overlaps.Num())].GetComponent()->GetComponentLocation();
+	SetControlRotation((Target - ViewLocation).Rotation());
+	return true;
+}
+
+void AGGTSoakBotController::TakeGrabCounts(int32& OutAttempts, int32& OutGrabs)
+{
+	OutAttempts = GrabAttempts;
+	OutGrabs = Grabs;
+
+	GrabAttempts = 0;
+	Grabs = 0;
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Controller.h"
+#include "GGTSoakBotController.generated.h"
+
+
+class AGGTCharacter;
+class AWeaponBase;
+
+
+/**
+ * Scripted player used by the soak test.
+ * Every think it aims at a random physics object nearby and grabs, fires, drops or re-equips, the same way a player would through the character.
+ */
+UCLASS()
+class GRAVITYGUNTEST_API AGGTSoakBotController : public AController
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Set the default values */
+		AGGTSoakBotController();
+
+		/** The shortest and longest time between two actions */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Soak")
+		float MinThinkInterval;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Soak")
+		float MaxThinkInterval;
+
+		/** How far away the bot looks for physics objects to aim at */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Soak")
+		float TargetSearchRadius;
+
+		/** Called every frame */
+		virtual void Tick(float DeltaTime) override;
+
+		/** Get how many grabs the bot tried and how many of them caught an object since the last call, and resets the counts */
+		void TakeGrabCounts(int32& OutAttempts, int32& OutGrabs);
+
+
+	protected:
+
+		/** Grabs tried and grabs that caught an object since TakeGrabCounts was last called */
+		int32 GrabAttempts;
+		int32 Grabs;
+
+		/** The weapon the bot dropped last, picked up again by the equip action */
+		TWeakObjectPtr<AWeaponBase> DroppedWeapon;
+
+		/** Time left until the next action */
+		float ThinkTimer;
+
+		/** Random stream of the bot, seeded from its name so runs can be repeated */
+		FRandomStream Random;
+
+		/** Picks and does one action */
+		void Think(AGGTCharacter* Character);
+
+		/** Turns the view toward a random physics object near the character, returns false if there is none */
+		bool AimAtRandomTarget(AGGTCharacter* Character);
+
+		/** Called when the game starts */
+		virtual void BeginPlay() override;
+};
@@ -0,0 +1,291 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GravityGunTest.h"
+#include "GGTProp.h"
+
+#include "General/GGTGameState.h"
+#include "General/GGTRewindBuffer.h"
+#include "General/GGTImpactQueue.h"
+#include "General/GGTPropReplication.h"
+#include "Engine/ActorChannel.h"
+#include "Net/DataBunch.h"
+
+
+// Sets default values
+AGGTProp::AGGTProp()
+{
+	// Props don't need to tick, the world level systems do the work for them
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Create the mesh component
+	PropMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("PropMesh"));
+	PropMesh->SetCollisionProfileName("PhysicsActor");
+	PropMesh->SetSimulatePhysics(true);
+	RootComponent = PropMesh;
+
+	bReplicates = true;
+	bReplicateMovement = true;
+
+	// Props at rest are made dormant by the prop replication system, the ones that move don't need to be sent every frame
+	NetUpdateFrequency = 30.0f;
+
+	RewindHandle = INDEX_NONE;
+	NetListIndex = INDEX_NONE;
+	bNetDormant = false;
+	bNetActive = false;
+	NetCell = FIntVector::ZeroValue;
+	HeldCount = 0;
+
+	MaxHealth = 0.0f;
+	ImpactImpulseThreshold = 50000.0f;
+	ImpulseToDamage = 0.001f;
+	MaxPredictedHoldError = 100.0f;
+
+	Health = 0.0f;
+	PendingImpulse = 0.0f;
+	bFractureQueued = false;
+	bHasImpulseDescriptor = false;
+}
+
+// Called when the game starts or when spawned
+void AGGTProp::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only the server validates traces, so only the server needs the history
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (HasAuthority() && GameState && GameState->RewindBuffer)
+		RewindHandle = GameState->RewindBuffer->RegisterProp(PropMesh);
+
+	// Relevancy and dormancy are decided by the server
+	if (HasAuthority() && GameState && GameState->PropReplication)
+		GameState->PropReplication->RegisterProp(this);
+
+	// Damage is handled by the server, and only for props that can break
+	Health = MaxHealth;
+	if (HasAuthority() && MaxHealth > 0.0f)
+	{
+		PropMesh->SetNotifyRigidBodyCollision(true);
+		PropMesh->OnComponentHit.AddDynamic(this, &AGGTProp::OnPropHit);
+	}
+}
+
+void AGGTProp::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Stop tracking the prop
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (RewindHandle != INDEX_NONE && GameState && GameState->RewindBuffer)
+		GameState->RewindBuffer->UnregisterProp(RewindHandle);
+
+	RewindHandle = INDEX_NONE;
+
+	if (NetListIndex != INDEX_NONE && GameState && GameState->PropReplication)
+		GameState->PropReplication->UnregisterProp(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGGTProp::OnPropHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// Filter out the small bumps before doing anything else, most hits end here
+	const float ImpulseSize = NormalImpulse.Size();
+	if (ImpulseSize < ImpactImpulseThreshold || bFractureQueued)
+		return;
+
+	// Only the first hit of the frame goes to the queue, the others just keep the strongest impulse
+	if (PendingImpulse <= 0.0f)
+	{
+		AGGTGameState* GameState = AGGTGameState::Get(this);
+		if (GameState == nullptr || GameState->ImpactQueue == nullptr)
+			return;
+
+		GameState->ImpactQueue->AddImpact(this);
+	}
+
+	PendingImpulse = FMath::Max(PendingImpulse, ImpulseSize);
+}
+
+void AGGTProp::ApplyPendingImpact()
+{
+	const float Damage = (PendingImpulse - ImpactImpulseThreshold) * ImpulseToDamage;
+	PendingImpulse = 0.0f;
+
+	if (Damage > 0.0f)
+		UGameplayStatics::ApplyDamage(this, Damage, nullptr, nullptr, UDamageType::StaticClass());
+}
+
+float AGGTProp::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (ActualDamage <= 0.0f || MaxHealth <= 0.0f || bFractureQueued)
+		return ActualDamage;
+
+	Health -= ActualDamage;
+
+	// Let the queue spawn the fracture when there is room for it
+	if (Health <= 0.0f)
+	{
+		AGGTGameState* GameState = AGGTGameState::Get(this);
+		if (GameState && GameState->ImpactQueue)
+		{
+			bFractureQueued = true;
+			GameState->ImpactQueue->AddFracture(this);
+		}
+	}
+
+	return ActualDamage;
+}
+
+void AGGTProp::Fracture()
+{
+	if (FractureClass)
+	{
+		// Spawn parameters
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnInfo.Instigator = Instigator;
+
+		// Spawn the replacement where the prop is, moving the same way
+		AActor* Fractured = GetWorld()->SpawnActor<AActor>(FractureClass, GetActorTransform(), SpawnInfo);
+		UPrimitiveComponent* FracturedRoot = Fractured ? Cast<UPrimitiveComponent>(Fractured->GetRootComponent()) : nullptr;
+
+		if (FracturedRoot && FracturedRoot->IsSimulatingPhysics())
+		{
+			FracturedRoot->SetAllPhysicsLinearVelocity(PropMesh->GetPhysicsLinearVelocity());
+			FracturedRoot->SetAllPhysicsAngularVelocity(PropMesh->GetPhysicsAngularVelocity());
+		}
+	}
+
+	Destroy();
+}
+
+float AGGTProp::GetHealth() const
+{
+	return Health;
+}
+
+bool AGGTProp::GetImpulseDescriptor(const UGGTImpulseProfileSet* ProfileSet, FGGTImpulseDescriptor& OutDescriptor)
+{
+	if (ProfileSet == nullptr)
+		return false;
+
+	// Most props are only ever fired by guns with the same profiles, so this resolves once
+	if (ImpulseProfileSet.Get() != ProfileSet)
+	{
+		ImpulseProfileSet = ProfileSet;
+		bHasImpulseDescriptor = ProfileSet->Resolve(PropMesh, ImpulseDescriptor);
+	}
+
+	OutDescriptor = ImpulseDescriptor;
+	return bHasImpulseDescriptor;
+}
+
+AGGTProp* AGGTProp::FromComponent(const UPrimitiveComponent* Component)
+{
+	AGGTProp* Prop = Component ? Cast<AGGTProp>(Component->GetOwner()) : nullptr;
+	return (Prop && Prop->PropMesh == Component) ? Prop : nullptr;
+}
+
+void AGGTProp::SetHeldByGun(bool bHeld)
+{
+	HeldCount = FMath::Max(HeldCount + (bHeld ? 1 : -1), 0);
+
+	if (bHeld)
+		WakeReplication();
+}
+
+void AGGTProp::WakeReplication()
+{
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (NetListIndex != INDEX_NONE && GameState && GameState->PropReplication)
+		GameState->PropReplication->WakeProp(this);
+}
+
+bool AGGTProp::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// Props that are not registered use the distance based relevancy of the engine
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (NetListIndex == INDEX_NONE || GameState == nullptr || GameState->PropReplication == nullptr)
+		return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+
+	return GameState->PropReplication->IsRelevant(this, SrcLocation);
+}
+
+void AGGTProp::PostNetReceivePhysicState()
+{
+	// Below the error the hold of the client wins, once it lets go the engine blends the prop back to the server state
+	if (Role < ROLE_Authority && HeldCount > 0)
+	{
+		if (FVector::DistSquared(ReplicatedMovement.Location, GetActorLocation()) <= FMath::Square(MaxPredictedHoldError))
+			return;
+	}
+
+	Super::PostNetReceivePhysicState();
+}
+
+bool AGGTProp::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	const bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+
+	// The actor channel calls this after the properties are written, so the bunch holds everything the prop sends this update
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (NetListIndex != INDEX_NONE && GameState && GameState->PropReplication)
+		GameState->PropReplication->AddPropBits(Channel->Connection, Bunch->GetNumBits());
+
+	return bWroteSomething;
+}
+
+float AGGTProp::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float Priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (!bNetActive || GameState == nullptr || GameState->PropReplication == nullptr)
+		return Priority;
+
+	return Priority * GameState->PropReplication->ActivePriorityScale;
+}
+
+int32 AGGTProp::SpawnGrid(UWorld* World, const FVector& Origin, const FVector& Forward, int32 Count, float Spacing)
+{
+	if (World == nullptr || Count <= 0)
+		return 0;
+
+	// The prop class itself has no mesh, so copy one that is placed in the level
+	UClass* PropClass = nullptr;
+	for (TActorIterator<AGGTProp> It(World); It; ++It)
+	{
+		PropClass = It->GetClass();
+		break;
+	}
+
+	if (PropClass == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AGGTProp::SpawnGrid: there is no prop in the world to copy"));
+		return 0;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// A square grid starting at the origin and growing forward
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)Count));
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+	const FVector Corner = Origin - (Right * Spacing * GridSize * 0.5f);
+
+	int32 Spawned = 0;
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Location = Corner + (Forward * Spacing * (i / GridSize)) + (Right * Spacing * (i % GridSize));
+
+		AGGTProp* Prop = World->SpawnActor<AGGTProp>(PropClass, FTransform(Location), SpawnInfo);
+		if (Prop == nullptr)
+			continue;
+
+		// Start at rest, so the props go dormant until something touches them
+		Prop->PropMesh->PutAllRigidBodiesToSleep();
+		Spawned++;
+	}
+
+	return Spawned;
+}
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "General/GGTImpulseProfileSet.h"
+#include "GGTProp.generated.h"
+
+/**
+ * A physics prop that can be grabbed and fired by the gravity gun.
+ * Props register themselves with the world level systems on the game state, for example the rewind buffer used for lag compensation.
+ */
+UCLASS()
+class GRAVITYGUNTEST_API AGGTProp : public AActor
+{
+	GENERATED_BODY()
+	
+	public:	
+
+		/** Sets default values for this actor's properties */
+		AGGTProp();
+
+		/** The simulated mesh of the prop */
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mesh")
+		UStaticMeshComponent* PropMesh;
+
+
+		/** How much damage the prop can take before it fractures. 0 makes the prop indestructible and disables its hit events. */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage", meta = (ClampMin = "0.0"))
+		float MaxHealth;
+
+		/** Impacts with a smaller impulse than this are ignored */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage", meta = (ClampMin = "0.0"))
+		float ImpactImpulseThreshold;
+
+		/** How much damage every unit of impulse above the threshold does */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage", meta = (ClampMin = "0.0"))
+		float ImpulseToDamage;
+
+		/** The pre-fractured actor that replaces the prop when its health reaches 0.
+		*	Leave empty to just remove the prop.
+		*/
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+		TSubclassOf<AActor> FractureClass;
+
+
+		/** How far the server may disagree with where a client holds the prop before the client is corrected.
+		*	The client moves a prop it holds itself, and the server holds it in the same place a moment later.
+		*/
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Replication", meta = (ClampMin = "0.0"))
+		float MaxPredictedHoldError;
+
+
+		/** Applies the strongest impact of the frame as damage, called by the impact queue */
+		void ApplyPendingImpact();
+
+		/** Replaces the prop with its fractured version, called by the impact queue */
+		void Fracture();
+
+		/** Reduces the health and queues the fracture when it reaches 0 */
+		virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+
+		/** Get the current health of the prop */
+		UFUNCTION(BlueprintCallable, Category = "Damage")
+		float GetHealth() const;
+
+
+		/** Get what a shot from a gun with the provided profiles does to the prop.
+		*	Resolved the first time the prop is grabbed or fired and cached, until a gun with other profiles asks.
+		*	Returns false if no profile matches the prop.
+		*/
+		bool GetImpulseDescriptor(const UGGTImpulseProfileSet* ProfileSet, FGGTImpulseDescriptor& OutDescriptor);
+
+		/** Get the prop the provided component is the mesh of, nullptr if it's not a prop mesh */
+		static AGGTProp* FromComponent(const UPrimitiveComponent* Component);
+
+
+		/** Called by gravity guns when they start and stop holding or pulling the prop. Held props replicate at a higher priority. */
+		void SetHeldByGun(bool bHeld);
+
+		/** Makes the prop replicate again right away, called when gameplay is about to move it */
+		void WakeReplication();
+
+		/** Only relevant to viewers close to the prop, see UGGTPropReplication */
+		virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+		/** Ignores small server corrections while the client holds the prop, so the client's hold and the server don't fight */
+		virtual void PostNetReceivePhysicState() override;
+
+		/** Counts the bits the prop wrote for the connection, so the prop replication can report its own bandwidth */
+		virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+		/** Raises the priority of props that are held or flying */
+		virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+		/** Spawns copies of the first prop class found in the world in a square grid, asleep. Returns how many were spawned. */
+		static int32 SpawnGrid(UWorld* World, const FVector& Origin, const FVector& Forward, int32 Count, float Spacing);
+
+
+	protected:
+
+		/** Handle of the prop in the rewind buffer, INDEX_NONE if it's not tracked */
+		int32 RewindHandle;
+
+		/** Replication state of the prop, owned by the prop replication system.
+		*	The index in its awake or dormant list, INDEX_NONE if it's not registered, the grid cell the prop was last seen in,
+		*	and if it's held or flying.
+		*/
+		int32 NetListIndex;
+		bool bNetDormant;
+		bool bNetActive;
+		FIntVector NetCell;
+
+		/** How many gravity guns are holding or pulling the prop */
+		int32 HeldCount;
+
+		friend class UGGTPropReplication;
+
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Damage")
+		float Health;
+
+		/** The strongest impulse the prop was hit with this frame, 0 if it has not been hit */
+		float PendingImpulse;
+
+		/** If the prop is waiting in the fracture queue */
+		bool bFractureQueued;
+
+		/** The cached impulse descriptor, the profiles it was resolved from and if any of them matched */
+		FGGTImpulseDescriptor ImpulseDescriptor;
+		TWeakObjectPtr<const UGGTImpulseProfileSet> ImpulseProfileSet;
+		bool bHasImpulseDescriptor;
+
+		/** Called when the prop mesh hits something */
+		UFUNCTION()
+		void OnPropHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+		/** Called when the game starts or when spawned */
+		virtual void BeginPlay() override;
+
+		/** Called when the objects is destroyed/removed or level transition */
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
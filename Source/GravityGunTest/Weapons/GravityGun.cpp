@@ -3,44 +3,239 @@
 #include "GravityGunTest.h"
 #include "GravityGun.h"
 
+#include "General/GGTGameState.h"
+#include "General/GGTRewindBuffer.h"
+#include "General/GGTPullPathCache.h"
+#include "General/GGTFixedStepClock.h"
+#include "General/GGTTelemetry.h"
+#include "General/GGTEffectScheduler.h"
+#include "Props/GGTProp.h"
+#include "DrawDebugHelpers.h"
+
 // Sets default values
 AGravityGun::AGravityGun()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	// Create the physics handle component
-	PhysicsHandle = CreateDefaultSubobject<UPhysicsHandleComponent>(TEXT("PhysicsHandle"));
-	PhysicsHandle->LinearDamping = 50.0f;
-	PhysicsHandle->InterpolationSpeed = 15.0f;
+	// The physics handle and the particle systems are only created while the gun is held
+	PhysicsHandle = nullptr;
+	BurstParticleComponent = nullptr;
+	PullParticleComponent = nullptr;
+	BurstParticle = nullptr;
+	PullParticle = nullptr;
+
+#if WITH_EDITORONLY_DATA
+	// The particle components used to be default subobjects with the templates set on them.
+	// They are kept in the editor only, so the templates saved in existing blueprints still load and can be moved over in PostLoad.
+	BurstParticleComponent_DEPRECATED = CreateEditorOnlyDefaultSubobject<UParticleSystemComponent>(TEXT("BurstParticleComponent"));
+	if (BurstParticleComponent_DEPRECATED)
+	{
+		BurstParticleComponent_DEPRECATED->bAutoActivate = false;
+		BurstParticleComponent_DEPRECATED->SetupAttachment(MuzzleLocation);
+	}
 
-	// Create the particle system components
-	BurstParticleComponent = CreateDefaultSubobject<UParticleSystemComponent>(TEXT("BurstParticleComponent"));
-	BurstParticleComponent->SetupAttachment(MuzzleLocation);
-	PullParticleComponent = CreateDefaultSubobject<UParticleSystemComponent>(TEXT("PullParticleComponent"));
-	PullParticleComponent->SetupAttachment(MuzzleLocation);
+	PullParticleComponent_DEPRECATED = CreateEditorOnlyDefaultSubobject<UParticleSystemComponent>(TEXT("PullParticleComponent"));
+	if (PullParticleComponent_DEPRECATED)
+	{
+		PullParticleComponent_DEPRECATED->bAutoActivate = false;
+		PullParticleComponent_DEPRECATED->SetupAttachment(MuzzleLocation);
+	}
+#endif
+	HoldLinearDamping = 50.0f;
+	HoldInterpolationSpeed = 15.0f;
+	BurstDuration = 0.3f;
+	bPullEffectActive = false;
 
 	TraceLength = 1500.0f;
 	MaxObjectDistance = 1600.0f;
 	ImpulsePower = 10000.0f;
+	ImpulseProfiles = nullptr;
 
 	FireCooldown = 0.5f;
 	CurrentFireDelay = 0.0f;
 
+	bTractorPull = true;
+	TractorGrabDistance = 200.0f;
+	TractorPullSpeed = 1500.0f;
+	TractorMaxAcceleration = 4000.0f;
+	TractorTimeout = 3.0f;
+	TractorStartTime = 0.0f;
+	TractorWaypoint = FVector::ZeroVector;
+
+	bHoldAddedObjectIgnore = false;
+	bHoldAddedHolderIgnore = false;
+
+	FixedStepClock = nullptr;
+	CurrentHoldTarget = FVector::ZeroVector;
+	PreviousHoldTarget = FVector::ZeroVector;
+
+	HoldMode = EGravityHoldMode::HM_KeepRelative;
+	HoldRotateSpeed = 2.0f;
+	HoldRadius = 0.0f;
+	HoldRotation = FQuat::Identity;
+	CurrentHoldRotation = FQuat::Identity;
+	PreviousHoldRotation = FQuat::Identity;
+
+	bPredictTrajectory = false;
+	bDrawTrajectory = false;
+	TrajectoryMaxTime = 2.0f;
+	TrajectoryTimeStep = 0.05f;
+	TrajectoryRecomputeDistance = 20.0f;
+	TrajectoryRecomputeAngle = 3.0f;
+	TrajectoryRecomputeInterval = 0.1f;
+	TrajectoryComputeTime = 0.0f;
+
+	bHasPredictedTrajectory = false;
+	PendingSweepSegment = INDEX_NONE;
+
 	// Set the weapon type
 	WeaponType = EWeaponType::WT_GravityGun;
 }
 
+void AGravityGun::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	// Move the templates of blueprints saved before the particle components were created on pickup
+	if (BurstParticle == nullptr && BurstParticleComponent_DEPRECATED)
+		BurstParticle = BurstParticleComponent_DEPRECATED->Template;
+
+	if (PullParticle == nullptr && PullParticleComponent_DEPRECATED)
+		PullParticle = PullParticleComponent_DEPRECATED->Template;
+
+	// The old components stay silent, the effects are played by the components created when the gun is held
+	if (BurstParticleComponent_DEPRECATED)
+		BurstParticleComponent_DEPRECATED->Template = nullptr;
+
+	if (PullParticleComponent_DEPRECATED)
+		PullParticleComponent_DEPRECATED->Template = nullptr;
+#endif
+}
+
 // Called when the game starts or when spawned
 void AGravityGun::BeginPlay()
 {
 	Super::BeginPlay();
+}
+
+void AGravityGun::OnStateChanged(EWeaponStates NewState)
+{
+	Super::OnStateChanged(NewState);
+
+	// A gun lying on the floor only keeps its mesh and muzzle
+	if (NewState == EWeaponStates::WS_Held)
+		CreateHeldState();
+	else
+		DestroyHeldState();
+}
+
+void AGravityGun::CreateHeldState()
+{
+	if (PhysicsHandle)
+		return;
+
+	// Create the physics handle component
+	PhysicsHandle = NewObject<UPhysicsHandleComponent>(this);
+	PhysicsHandle->LinearDamping = HoldLinearDamping;
+	PhysicsHandle->InterpolationSpeed = HoldInterpolationSpeed;
+	PhysicsHandle->RegisterComponent();
+
+	// Create the particle system components, only for the effects that are set
+	BurstParticleComponent = CreateParticleComponent(BurstParticle);
+	PullParticleComponent = CreateParticleComponent(PullParticle);
+
+	// The trajectory parameters are filled in when an object is held
+	TrajectoryParams.Reset(new FCollisionQueryParams(GetGravityTraceParams()));
+
+	// Let the scheduler spread the trajectory sweeps over frames
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->QueryScheduler)
+		GameState->QueryScheduler->RegisterClient(this);
+
+	// Run the gameplay logic on the fixed step clock, and make sure the clock has stepped before the frame tick blends
+	if (GameState && GameState->FixedStepClock)
+	{
+		FixedStepClock = GameState->FixedStepClock;
+		FixedStepHandle = FixedStepClock->OnFixedStep.AddUObject(this, &AGravityGun::FixedTick);
+		AddTickPrerequisiteComponent(FixedStepClock);
+	}
+}
+
+void AGravityGun::DestroyHeldState()
+{
+	if (PhysicsHandle == nullptr)
+		return;
+
+	// Let go of anything that is still held or pulled
+	DropWeapon();
+
+	// Stop running on the fixed step
+	if (FixedStepClock)
+	{
+		FixedStepClock->OnFixedStep.Remove(FixedStepHandle);
+		RemoveTickPrerequisiteComponent(FixedStepClock);
+	}
+	FixedStepClock = nullptr;
+
+	// Stop receiving scene queries
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->QueryScheduler)
+		GameState->QueryScheduler->UnregisterClient(this);
+
+	// Free the trajectory arrays, ClearTrajectory keeps them allocated for reuse while held
+	ClearTrajectory();
+	PendingTrajectory.Points.Empty();
+	PredictedTrajectory.Points.Empty();
+	TrajectoryParams.Reset();
+
+	PhysicsHandle->DestroyComponent();
+	PhysicsHandle = nullptr;
+
+	// A burst that is still playing doesn't need its deactivation anymore
+	if (BurstParticleComponent && GameState && GameState->EffectScheduler)
+		GameState->EffectScheduler->CancelDeactivation(BurstParticleComponent);
+
+	if (BurstParticleComponent)
+		BurstParticleComponent->DestroyComponent();
+	BurstParticleComponent = nullptr;
+
+	if (PullParticleComponent)
+		PullParticleComponent->DestroyComponent();
+	PullParticleComponent = nullptr;
+	bPullEffectActive = false;
+}
+
+UParticleSystemComponent* AGravityGun::CreateParticleComponent(UParticleSystem* Template)
+{
+	if (Template == nullptr)
+		return nullptr;
+
+	UParticleSystemComponent* ParticleComponent = NewObject<UParticleSystemComponent>(this);
+	ParticleComponent->bAutoActivate = false;
+	ParticleComponent->SetTemplate(Template);
+	ParticleComponent->SetupAttachment(MuzzleLocation);
+	ParticleComponent->RegisterComponent();
+	return ParticleComponent;
+}
+
+const FCollisionQueryParams& AGravityGun::GetGravityTraceParams()
+{
+	// Simple collision and no physical material, the impulse profiles read the material from the body
+	static const FCollisionQueryParams GravityTraceParams(FName(TEXT("Gravity Trace")), false, nullptr);
+	return GravityTraceParams;
+}
+
+FCollisionQueryParams AGravityGun::GetTraceParams() const
+{
+	// Only the ignores depend on the gun, they are added to a copy of the shared parameters when tracing
+	FCollisionQueryParams TraceParams = GetGravityTraceParams();
+	TraceParams.AddIgnoredActor(this);
+	if (GetHolder())
+		TraceParams.AddIgnoredActor(GetHolder());
 
-	// Trace parameters
-	TraceParams = FCollisionQueryParams(FName(TEXT("Gravity Trace")), false, nullptr);
-	TraceParams.bReturnPhysicalMaterial = false;
-	TraceParams.bTraceComplex = false;
-	TraceParams.AddIgnoredActor(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+	return TraceParams;
 }
 
 // Called every frame
@@ -48,60 +243,93 @@ void AGravityGun::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// Count down the fire delay
-	if (CurrentFireDelay > 0.0f)
-		CurrentFireDelay -= DeltaTime;
+	// Only held guns do anything every frame
+	if (PhysicsHandle == nullptr)
+		return;
 
+	// Without the fixed step clock the gameplay logic runs every frame instead
+	if (FixedStepClock == nullptr)
+	{
+		FixedTick(DeltaTime);
+		PreviousHoldTarget = CurrentHoldTarget;
+		PreviousHoldRotation = CurrentHoldRotation;
+	}
+
+	// Pull once per physics frame, the path is updated on the gameplay steps
+	if (TractorComponent.IsValid())
+		ApplyTractorForce(DeltaTime);
 
 	if (PhysicsHandle->GetGrabbedComponent())
 	{
-		// Calculate the new target location.
-		// The target location is relative to the object that the gun has grabbed, the bigger the gun, the further away the object is.
-		FVector HandleTargetLocation;
-		HandleTargetLocation = MuzzleLocation->GetComponentLocation() + (MuzzleLocation->GetForwardVector() * (PhysicsHandle->GetGrabbedComponent()->Bounds.GetSphere().W + 100.0f));
+		// Blend the target between the last two gameplay steps so the held object moves smoothly at any frame rate
+		const float Alpha = FixedStepClock ? FixedStepClock->GetInterpolationAlpha() : 1.0f;
+		const FVector TargetLocation = FMath::Lerp(PreviousHoldTarget, CurrentHoldTarget, Alpha);
+
+		// Set the target of the physics handle, free objects only follow the location.
+		if (HoldMode == EGravityHoldMode::HM_Free)
+			PhysicsHandle->SetTargetLocation(TargetLocation);
+		else
+			PhysicsHandle->SetTargetLocationAndRotation(TargetLocation, FQuat::Slerp(PreviousHoldRotation, CurrentHoldRotation, Alpha).Rotator());
+	}
+}
 
-		// Move the object up a bit to have more in the middle of the screen
-		// And then clamp the value so that there is a limit to how far down it can go, to prevent the physics from bugging with the ground.
-		HandleTargetLocation.Z += 25.0f;
-		HandleTargetLocation.Z = FMath::Clamp(HandleTargetLocation.Z, MuzzleLocation->GetComponentLocation().Z + (PhysicsHandle->GetGrabbedComponent()->Bounds.GetSphere().W * 0.1f), MuzzleLocation->GetComponentLocation().Z + 300.0f);
-		
-		// Set the target location of the physics handle.
-		PhysicsHandle->SetTargetLocation(HandleTargetLocation);
+void AGravityGun::FixedTick(float StepTime)
+{
+	// Guns that are put away in an inventory slot do nothing
+	if (!IsWeaponActive() || PhysicsHandle == nullptr)
+		return;
 
+	// Count down the fire delay
+	if (CurrentFireDelay > 0.0f)
+		CurrentFireDelay -= StepTime;
 
-		// Make sure that the player cannot walk too far away from the grabbed object.
-		float Distance = FMath::Abs(FVector::Distance(PhysicsHandle->GetGrabbedComponent()->GetComponentLocation(), GetActorLocation()));
-		if (Distance > MaxObjectDistance)
-		{
-			// Set the collision response with the player back to block and reduce it's velocity
-			PhysicsHandle->GetGrabbedComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECollisionResponse::ECR_Block);
-			PhysicsHandle->GetGrabbedComponent()->SetAllPhysicsLinearVelocity(PhysicsHandle->GetGrabbedComponent()->GetPhysicsLinearVelocity() * 0.25f);
 
-			// And release the object
-			PhysicsHandle->ReleaseComponent();
-		}
+	// Let go of objects that were destroyed while held, for example props that fractured
+	if (PhysicsHandle->GetGrabbedComponent() && PhysicsHandle->GetGrabbedComponent()->IsPendingKill())
+		ReleaseHeldObject(1.0f);
 
+	if (UPrimitiveComponent* GrabbedComp = PhysicsHandle->GetGrabbedComponent())
+	{
+		// Move the hold target forward one step, the frame tick blends between the last two
+		PreviousHoldTarget = CurrentHoldTarget;
+		CurrentHoldTarget = GetHoldTargetLocation(GrabbedComp);
 
-		// Active the pull particle system
-		if (PullParticleComponent && PullParticleComponent->FXSystem && !PullParticleComponent->IsActive())
+		// The hold rotation is in the space of the muzzle, so the object turns with the view
+		if (HoldMode != EGravityHoldMode::HM_Free)
 		{
-			PullParticleComponent->ActivateSystem();
+			PreviousHoldRotation = CurrentHoldRotation;
+			CurrentHoldRotation = MuzzleLocation->GetComponentQuat() * HoldRotation;
+			CurrentHoldRotation.Normalize();
 		}
-	}
-	else
-	{
-		// Deactive the pull system
-		if (PullParticleComponent && PullParticleComponent->FXSystem)
+
+		// Make sure that the player cannot walk too far away from the grabbed object.
+		const float Distance = FVector::Distance(GrabbedComp->GetComponentLocation(), GetActorLocation());
+		if (Distance > MaxObjectDistance)
 		{
-			PullParticleComponent->DeactivateSystem();
+			// Reduce it's velocity and release the object
+			UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::DistanceRelease, this, GrabbedComp, Distance);
+			ReleaseHeldObject(0.25f);
 		}
 	}
+	else if (TractorComponent.IsValid())
+	{
+		UpdateTractorPull(StepTime);
+	}
 
+	// Keep the trajectory prediction up to date with what is held
+	if (bPredictTrajectory && PhysicsHandle->GetGrabbedComponent())
+	{
+		UpdateTrajectory();
+	}
+	else if (TrajectoryComponent.IsValid() || bHasPredictedTrajectory)
+	{
+		ClearTrajectory();
+	}
 }
 
 bool AGravityGun::Fire(FVector TraceStart, FVector Direction)
 {
-	if (CurrentFireDelay > 0.0f)
+	if (CurrentFireDelay > 0.0f || PhysicsHandle == nullptr)
 		return false;
 
 	// Play the different effects.
@@ -110,19 +338,21 @@ bool AGravityGun::Fire(FVector TraceStart, FVector Direction)
 		UGameplayStatics::SpawnSoundAttached(FireSound, WeaponMesh);
 		UGameplayStatics::PlayWorldCameraShake(GetWorld(), CameraShake, GetActorLocation(), 0.0f, 300.0f);
 		
-		// Activate the system and set the timer to deactivate it
+		// Activate the system and let the effect scheduler deactivate it, firing again restarts the duration
 		BurstParticleComponent->ActivateSystem();
-		GetWorldTimerManager().SetTimer(BurstTimerHandle, this, &AGravityGun::BurstSystemDeactivate, 0.3f, false);
+
+		AGGTGameState* GameState = AGGTGameState::Get(this);
+		if (GameState && GameState->EffectScheduler)
+			GameState->EffectScheduler->ScheduleDeactivation(BurstParticleComponent, BurstDuration);
 	}
 
+	// Stop pulling, the pulled object can still be hit by the trace below
+	StopTractorPull();
+
 	// Temporary reference to the component the gun is holding. Since it will be released here.
 	UPrimitiveComponent* ReleasedComp = PhysicsHandle->GetGrabbedComponent();
 
-	if (PhysicsHandle->GetGrabbedComponent())
-	{
-		PhysicsHandle->GetGrabbedComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECollisionResponse::ECR_Block);
-		PhysicsHandle->ReleaseComponent();
-	}
+	ReleaseHeldObject(1.0f);
 
 	// Set the cooldown
 	CurrentFireDelay = FireCooldown;
@@ -132,19 +362,13 @@ bool AGravityGun::Fire(FVector TraceStart, FVector Direction)
 	{
 		// Check if the object is close enough to the gun.
 		// Do this since the object can potentially be quite a distance away and it would look strange if it was fired away at that distance
-		FVector HandleTargetLocation = MuzzleLocation->GetComponentLocation() + (MuzzleLocation->GetForwardVector() * (ReleasedComp->Bounds.GetSphere().W + 100.0f));
-		HandleTargetLocation.Z += 25.0f;
-		HandleTargetLocation.Z = FMath::Clamp(HandleTargetLocation.Z, MuzzleLocation->GetComponentLocation().Z + (ReleasedComp->Bounds.GetSphere().W * 0.1f), MuzzleLocation->GetComponentLocation().Z + 300.0f);
-
-		float Distance = FMath::Abs(FVector::Distance(ReleasedComp->GetComponentLocation(), HandleTargetLocation));
-		if (Distance <= 200.0f)
+		float Distance = FMath::Abs(FVector::Distance(ReleasedComp->GetComponentLocation(), GetHoldTargetLocation(ReleasedComp)));
+		if (Distance <= TractorGrabDistance)
 		{
-			// First set all velocity to 0
-			ReleasedComp->SetAllPhysicsLinearVelocity(FVector::ZeroVector);
+			// Launch with the descriptor cached when the object was grabbed
+			LaunchComponent(ReleasedComp, HeldDescriptor);
 
-			// Calculate the impulse using the objects mass and then add it.
-			FVector Impulse = MuzzleLocation->GetForwardVector() * (ImpulsePower * ReleasedComp->GetMass());
-			ReleasedComp->AddImpulse(Impulse);
+			UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Fire, this, ReleasedComp, HeldDescriptor.LaunchSpeed);
 			
 			return true;	
 		}
@@ -152,56 +376,59 @@ bool AGravityGun::Fire(FVector TraceStart, FVector Direction)
 
 	// If the held object could not be fired, because it was too far away from the gun, do a line trace to see if there is anything else to hit.
 	FHitResult hitResult(ForceInit);
-	FVector startFVector = TraceStart;
-	FVector endFVector = startFVector + (Direction * TraceLength);
 
-	if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, TraceParams))
+	if (TraceForTarget(TraceStart, Direction, hitResult))
 	{
 		// Make sure that the object is simulating physics
-		if (hitResult.GetComponent()->IsSimulatingPhysics() && !hitResult.GetComponent()->ComponentHasTag("Weapon"))
+		if (IsGrabbable(hitResult.GetComponent()))
 		{
-			hitResult.GetComponent()->SetAllPhysicsLinearVelocity(FVector::ZeroVector);
+			const FGGTImpulseDescriptor Descriptor = GetImpulseDescriptor(hitResult.GetComponent());
+			LaunchComponent(hitResult.GetComponent(), Descriptor);
 
-			// Calculate the impulse using the objects mass and then add it.
-			FVector Impulse = MuzzleLocation->GetForwardVector() * (ImpulsePower * hitResult.GetComponent()->GetMass());
-			hitResult.GetComponent()->AddImpulse(Impulse);
+			UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Fire, this, hitResult.GetComponent(), Descriptor.LaunchSpeed);
+			return true;
 		}
 	}
 
+	// Fired at nothing that could be pushed
+	UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Fire, this, nullptr, 0.0f);
 	return true;
 }
 
 bool AGravityGun::AltFire(FVector TraceStart, FVector Direction)
 {
+	if (PhysicsHandle == nullptr)
+		return false;
+
+	// If the gun is pulling something, let go of it
+	if (TractorComponent.IsValid())
+	{
+		StopTractorPull();
+		return true;
+	}
+
 	// If the handle already has something grabbed, release it.
 	if (PhysicsHandle->GetGrabbedComponent())
 	{
-		// Set the collision response with the player back to block and reduce it's velocity
-		PhysicsHandle->GetGrabbedComponent()->SetAllPhysicsLinearVelocity(PhysicsHandle->GetGrabbedComponent()->GetPhysicsLinearVelocity() * 0.25f);
-		PhysicsHandle->GetGrabbedComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECollisionResponse::ECR_Block);
-		PhysicsHandle->ReleaseComponent();
+		// Reduce it's velocity and release it
+		ReleaseHeldObject(0.25f);
 		return true;
 	}
 
 	// Do a trace to see if there is any objects that can be picked up
 	FHitResult hitResult(ForceInit);
-	FVector startFVector = TraceStart;
-	FVector endFVector = startFVector + (Direction * TraceLength);
 
-	if (GetWorld()->LineTraceSingleByChannel(hitResult, startFVector, endFVector, ECC_Visibility, TraceParams))
+	if (TraceForTarget(TraceStart, Direction, hitResult))
 	{
 		// Make sure that the object is simulating physics, and stop interaction between weapons
-		if (hitResult.GetComponent()->IsSimulatingPhysics() && !hitResult.GetComponent()->ComponentHasTag("Weapon"))
+		if (IsGrabbable(hitResult.GetComponent()))
 		{
-			// Grab the physics object
-			PhysicsHandle->GrabComponentAtLocationWithRotation(hitResult.GetComponent(), "", hitResult.GetComponent()->GetComponentLocation(), hitResult.GetComponent()->GetComponentRotation());
-
-			// Set the collision response with the player to ignore so that they don't constantly collide
-			PhysicsHandle->GetGrabbedComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECollisionResponse::ECR_Ignore);
-
-			// Play the pull sound
-			if(PullSound)
-				UGameplayStatics::SpawnSoundAttached(PullSound, WeaponMesh);
+			// Objects far away are pulled in over time, so the physics handle doesn't yank them across the map in one solve
+			const float Distance = FVector::Distance(hitResult.GetComponent()->GetComponentLocation(), GetHoldTargetLocation(hitResult.GetComponent()));
+			if (bTractorPull && Distance > TractorGrabDistance)
+				StartTractorPull(hitResult.GetComponent());
+			else
+				GrabComponent(hitResult.GetComponent());
 		}
 	}
 
@@ -211,23 +438,553 @@ bool AGravityGun::AltFire(FVector TraceStart, FVector Direction)
 
 void AGravityGun::DropWeapon()
 {
-	if (PhysicsHandle && PhysicsHandle->GetGrabbedComponent())
+	StopTractorPull();
+
+	// Reduce the velocity of the held object before release
+	if (PhysicsHandle)
+		ReleaseHeldObject(0.25f);
+}
+
+FWeaponTargetingInfo AGravityGun::GetTargetingInfo() const
+{
+	FWeaponTargetingInfo Info;
+	Info.bHoverTrace = true;
+	Info.HoverTraceLength = TraceLength;
+	Info.IsHoverTarget = &AGravityGun::IsGrabbable;
+	return Info;
+}
+
+float AGravityGun::GetFireDelay() const
+{
+	return FMath::Max(CurrentFireDelay, 0.0f);
+}
+
+void AGravityGun::SetFireDelay(float NewFireDelay)
+{
+	CurrentFireDelay = NewFireDelay;
+}
+
+void AGravityGun::GetHeldObject(UPrimitiveComponent*& OutComponent, bool& bOutPulling) const
+{
+	bOutPulling = TractorComponent.IsValid();
+	OutComponent = bOutPulling ? TractorComponent.Get() : (PhysicsHandle ? PhysicsHandle->GetGrabbedComponent() : nullptr);
+}
+
+bool AGravityGun::ReconcileHeldObject(UPrimitiveComponent* ServerComponent, bool bServerPulling)
+{
+	if (PhysicsHandle == nullptr)
+		return false;
+
+	UPrimitiveComponent* LocalComponent = nullptr;
+	bool bLocalPulling = false;
+	GetHeldObject(LocalComponent, bLocalPulling);
+
+	if (LocalComponent == ServerComponent && bLocalPulling == bServerPulling)
+		return false;
+
+	// Let go of what the client guessed, the server corrects where the object is
+	StopTractorPull();
+	ReleaseHeldObject(1.0f);
+
+	if (ServerComponent && IsGrabbable(ServerComponent))
 	{
-		// Set the collision response with the player back to block and reduce it's velocity before release
-		PhysicsHandle->GetGrabbedComponent()->SetAllPhysicsLinearVelocity(PhysicsHandle->GetGrabbedComponent()->GetPhysicsLinearVelocity() * 0.25f);
-		PhysicsHandle->GetGrabbedComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECollisionResponse::ECR_Block);
-		PhysicsHandle->ReleaseComponent();
+		if (bServerPulling)
+			StartTractorPull(ServerComponent);
+		else
+			GrabComponent(ServerComponent);
 	}
+
+	return true;
+}
+
+bool AGravityGun::IsGrabbable(const UPrimitiveComponent* Component)
+{
+	// Make sure that the object is simulating physics, and stop interaction between weapons
+	return Component && Component->IsSimulatingPhysics() && !Component->ComponentHasTag("Weapon");
+}
+
+void AGravityGun::SetWeaponActive(bool bNewActive)
+{
+	// Let go of the held object the same way as when the weapon is dropped
+	if (!bNewActive)
+		DropWeapon();
+
+	Super::SetWeaponActive(bNewActive);
+
+	// The physics handle ticks on its own, stop it as well while the gun is put away
+	if (PhysicsHandle)
+		PhysicsHandle->SetComponentTickEnabled(bNewActive);
 }
 
-void AGravityGun::BurstSystemDeactivate()
+FVector AGravityGun::GetHoldTargetLocation(UPrimitiveComponent* Component) const
 {
-	// Stop the system
-	BurstParticleComponent->DeactivateSystem();
+	// The held or pulled object uses the radius cached when it was picked, other objects compute theirs
+	const bool bIsTarget = (PhysicsHandle && PhysicsHandle->GetGrabbedComponent() == Component) || TractorComponent.Get() == Component;
+	const float Radius = bIsTarget ? HoldRadius : GetLocalRadius(Component);
+
+	// The target location is relative to the object that the gun has grabbed, the bigger the object, the further away it is.
+	const FVector MuzzlePosition = MuzzleLocation->GetComponentLocation();
+	FVector HandleTargetLocation = MuzzlePosition + (MuzzleLocation->GetForwardVector() * (Radius + 100.0f));
+
+	// Move the object up a bit to have more in the middle of the screen
+	// And then clamp the value so that there is a limit to how far down it can go, to prevent the physics from bugging with the ground.
+	HandleTargetLocation.Z += 25.0f;
+	HandleTargetLocation.Z = FMath::Clamp(HandleTargetLocation.Z, MuzzlePosition.Z + (Radius * 0.1f), MuzzlePosition.Z + 300.0f);
+
+	return HandleTargetLocation;
+}
+
+float AGravityGun::GetLocalRadius(const UPrimitiveComponent* Component)
+{
+	// Bounds in the space of the object, so the radius doesn't change when the object turns
+	const FBoxSphereBounds LocalBounds = Component->CalcBounds(FTransform(FQuat::Identity, FVector::ZeroVector, Component->GetComponentScale()));
+	return LocalBounds.SphereRadius + LocalBounds.Origin.Size();
+}
+
+void AGravityGun::SetHoldMode(EGravityHoldMode NewHoldMode)
+{
+	HoldMode = NewHoldMode;
+
+	UPrimitiveComponent* GrabbedComp = PhysicsHandle ? PhysicsHandle->GetGrabbedComponent() : nullptr;
+	if (GrabbedComp == nullptr)
+		return;
+
+	// Switching between free and controlled rotation changes the constraint of the handle, so grab the object again
+	ReleaseHeldObject(1.0f);
+	GrabComponent(GrabbedComp);
+}
+
+void AGravityGun::AddHoldRotationInput(float Yaw, float Pitch)
+{
+	if (HoldMode != EGravityHoldMode::HM_PlayerRotate || PhysicsHandle == nullptr || PhysicsHandle->GetGrabbedComponent() == nullptr)
+		return;
+
+	// Turn the object around the up and right axes of the view, the hold rotation is in the space of the muzzle
+	const FQuat YawRotation(FVector::UpVector, FMath::DegreesToRadians(Yaw * HoldRotateSpeed));
+	const FQuat PitchRotation(FVector::RightVector, FMath::DegreesToRadians(-Pitch * HoldRotateSpeed));
+
+	HoldRotation = YawRotation * PitchRotation * HoldRotation;
+	HoldRotation.Normalize();
+}
+
+void AGravityGun::GrabComponent(UPrimitiveComponent* Component)
+{
+	// Cache the size of the object once, the world bounds change every time it turns
+	HoldRadius = GetLocalRadius(Component);
+	HeldDescriptor = GetImpulseDescriptor(Component);
+
+	// The rotation of the object relative to the muzzle, aligned objects face the same way as the view
+	const FQuat MuzzleRotation = MuzzleLocation->GetComponentQuat();
+	HoldRotation = (HoldMode == EGravityHoldMode::HM_AlignToView) ? FQuat::Identity : MuzzleRotation.Inverse() * Component->GetComponentQuat();
+	HoldRotation.Normalize();
+
+	// Grab the physics object, free objects can turn on their own
+	if (HoldMode == EGravityHoldMode::HM_Free)
+		PhysicsHandle->GrabComponentAtLocation(Component, NAME_None, Component->GetComponentLocation());
+	else
+		PhysicsHandle->GrabComponentAtLocationWithRotation(Component, NAME_None, Component->GetComponentLocation(), Component->GetComponentRotation());
+
+	// Start holding the object where it's going to be on the next step
+	CurrentHoldTarget = GetHoldTargetLocation(Component);
+	PreviousHoldTarget = CurrentHoldTarget;
+	CurrentHoldRotation = Component->GetComponentQuat();
+	PreviousHoldRotation = CurrentHoldRotation;
+
+	// Make the object and the holder ignore each other when moving, other pawns still collide with it
+	BeginHoldCollision(Component);
+
+	// Held props replicate at a higher priority
+	if (AGGTProp* Prop = AGGTProp::FromComponent(Component))
+		Prop->SetHeldByGun(true);
+
+	UpdatePullEffect();
+
+	UGGTTelemetry::RecordEvent(this, EGGTTelemetryEvent::Grab, this, Component, FVector::Distance(Component->GetComponentLocation(), MuzzleLocation->GetComponentLocation()));
+
+	// Play the pull sound
+	if(PullSound)
+		UGameplayStatics::SpawnSoundAttached(PullSound, WeaponMesh);
+}
+
+void AGravityGun::ReleaseHeldObject(float VelocityScale)
+{
+	UPrimitiveComponent* GrabbedComp = PhysicsHandle ? PhysicsHandle->GetGrabbedComponent() : nullptr;
+	if (GrabbedComp == nullptr)
+		return;
+
+	EndHoldCollision(GrabbedComp);
+
+	if (AGGTProp* Prop = AGGTProp::FromComponent(GrabbedComp))
+		Prop->SetHeldByGun(false);
+
+	if (VelocityScale != 1.0f && !GrabbedComp->IsPendingKill())
+		GrabbedComp->SetAllPhysicsLinearVelocity(GrabbedComp->GetPhysicsLinearVelocity() * VelocityScale);
+
+	PhysicsHandle->ReleaseComponent();
+
+	UpdatePullEffect();
+}
+
+void AGravityGun::UpdatePullEffect()
+{
+	// The pull effect is used both while holding and pulling, it's only touched when that changes
+	const bool bWantPullEffect = (PhysicsHandle && PhysicsHandle->GetGrabbedComponent()) || TractorComponent.IsValid();
+	if (bWantPullEffect == bPullEffectActive)
+		return;
+
+	bPullEffectActive = bWantPullEffect;
+
+	if (PullParticleComponent == nullptr || PullParticleComponent->FXSystem == nullptr)
+		return;
+
+	if (bPullEffectActive)
+		PullParticleComponent->ActivateSystem();
+	else
+		PullParticleComponent->DeactivateSystem();
+}
+
+void AGravityGun::BeginHoldCollision(UPrimitiveComponent* Component)
+{
+	APawn* Holder = GetHolder();
+	UPrimitiveComponent* HolderRoot = Holder ? Cast<UPrimitiveComponent>(Holder->GetRootComponent()) : nullptr;
+
+	HoldCollisionHolder = Holder;
+
+	// Remember if the ignores were already there, so the release only removes what the grab added.
+	// Only the move ignore lists change, the collision filter of the body is left as it is.
+	bHoldAddedObjectIgnore = Holder && !Component->GetMoveIgnoreActors().Contains(Holder);
+	if (bHoldAddedObjectIgnore)
+		Component->IgnoreActorWhenMoving(Holder, true);
+
+	bHoldAddedHolderIgnore = HolderRoot && !HolderRoot->GetMoveIgnoreComponents().Contains(Component);
+	if (bHoldAddedHolderIgnore)
+		HolderRoot->IgnoreComponentWhenMoving(Component, true);
+}
+
+void AGravityGun::EndHoldCollision(UPrimitiveComponent* Component)
+{
+	APawn* Holder = HoldCollisionHolder.Get();
+	UPrimitiveComponent* HolderRoot = Holder ? Cast<UPrimitiveComponent>(Holder->GetRootComponent()) : nullptr;
+
+	if (bHoldAddedObjectIgnore && Holder && !Component->IsPendingKill())
+		Component->IgnoreActorWhenMoving(Holder, false);
+
+	if (bHoldAddedHolderIgnore && HolderRoot)
+		HolderRoot->IgnoreComponentWhenMoving(Component, false);
+
+	HoldCollisionHolder.Reset();
+	bHoldAddedObjectIgnore = false;
+	bHoldAddedHolderIgnore = false;
+}
+
+void AGravityGun::StartTractorPull(UPrimitiveComponent* Component)
+{
+	StopTractorPull();
+
+	TractorComponent = Component;
+	TractorStartTime = GetWorld()->GetTimeSeconds();
+	HoldRadius = GetLocalRadius(Component);
+	TractorWaypoint = GetHoldTargetLocation(Component);
+
+	// Share the path with any other gun pulling the same object
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->PullPathCache)
+		GameState->PullPathCache->AddPuller(Component);
+
+	if (AGGTProp* Prop = AGGTProp::FromComponent(Component))
+		Prop->SetHeldByGun(true);
+
+	UpdatePullEffect();
+
+	// Play the pull sound
+	if (PullSound)
+		UGameplayStatics::SpawnSoundAttached(PullSound, WeaponMesh);
+}
+
+void AGravityGun::StopTractorPull()
+{
+	const bool bWasPulling = TractorComponent.IsValid();
+	UPrimitiveComponent* Component = TractorComponent.Get();
+	TractorComponent.Reset();
+
+	if (bWasPulling)
+		UpdatePullEffect();
+
+	if (Component == nullptr)
+		return;
+
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->PullPathCache)
+		GameState->PullPathCache->RemovePuller(Component);
+
+	if (AGGTProp* Prop = AGGTProp::FromComponent(Component))
+		Prop->SetHeldByGun(false);
+}
+
+void AGravityGun::UpdateTractorPull(float DeltaTime)
+{
+	UPrimitiveComponent* Component = TractorComponent.Get();
+	if (Component == nullptr || Component->IsPendingKill() || !Component->IsSimulatingPhysics() || DeltaTime <= 0.0f)
+	{
+		StopTractorPull();
+		return;
+	}
+
+	const FVector HoldTarget = GetHoldTargetLocation(Component);
+	const FVector ObjectLocation = Component->GetComponentLocation();
+
+	// Grab the object once it has arrived
+	if (FVector::DistSquared(ObjectLocation, HoldTarget) <= FMath::Square(TractorGrabDistance))
+	{
+		// Grab first so the pull effect keeps playing through the hand over
+		GrabComponent(Component);
+		StopTractorPull();
+		return;
+	}
+
+	// Give up on objects that are stuck or that the player walked away from
+	if (GetWorld()->GetTimeSeconds() - TractorStartTime > TractorTimeout || FVector::DistSquared(ObjectLocation, GetActorLocation()) > FMath::Square(MaxObjectDistance))
+	{
+		StopTractorPull();
+		return;
+	}
+
+	// Move toward the next point on the path, which goes around obstacles. The force is applied by the frame tick.
+	TractorWaypoint = HoldTarget;
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState && GameState->PullPathCache)
+		TractorWaypoint = GameState->PullPathCache->GetNextWaypoint(Component, HoldTarget);
+}
+
+void AGravityGun::ApplyTractorForce(float DeltaTime)
+{
+	UPrimitiveComponent* Component = TractorComponent.Get();
+	if (Component == nullptr || Component->IsPendingKill() || !Component->IsSimulatingPhysics() || DeltaTime <= 0.0f)
+		return;
+
+	// Steer the velocity toward the wanted velocity, cancelling gravity.
+	// The acceleration is capped, so the force is capped by the mass of the object.
+	// A force lasts one physics frame, so it's added once per frame with the time of that frame, however many gameplay steps ran.
+	const FVector WantedVelocity = (TractorWaypoint - Component->GetComponentLocation()).GetSafeNormal() * TractorPullSpeed;
+	const FVector Gravity(0.0f, 0.0f, GetWorld()->GetGravityZ());
+	const FVector Acceleration = ((WantedVelocity - Component->GetPhysicsLinearVelocity()) / DeltaTime) - Gravity;
+
+	Component->AddForce(Acceleration.GetClampedToMaxSize(TractorMaxAcceleration), NAME_None, true);
+}
+
+bool AGravityGun::TraceForTarget(const FVector& TraceStart, const FVector& Direction, FHitResult& OutHit) const
+{
+	const FVector TraceEnd = TraceStart + (Direction * TraceLength);
+	bool bHit = GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, GetTraceParams());
+
+	// Only the server rewinds, and only for fires coming from remote clients
+	if (FireRewindTime < 0.0f)
+		return bHit;
+
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState == nullptr || GameState->RewindBuffer == nullptr)
+		return bHit;
+
+	// Use the prop the client saw if it was in front of whatever the trace hit in the current world
+	FGGTRewindHit RewindHit;
+	if (GameState->RewindBuffer->RewindLineTrace(TraceStart, TraceEnd, FireRewindTime, RewindHit) && (!bHit || RewindHit.Distance <= OutHit.Distance))
+	{
+		OutHit = FHitResult(RewindHit.Component->GetOwner(), RewindHit.Component, RewindHit.Location, -Direction);
+		OutHit.Distance = RewindHit.Distance;
+		OutHit.TraceStart = TraceStart;
+		OutHit.TraceEnd = TraceEnd;
+		bHit = true;
+	}
+
+	return bHit;
+}
+
+FGGTImpulseDescriptor AGravityGun::GetImpulseDescriptor(UPrimitiveComponent* Component) const
+{
+	FGGTImpulseDescriptor Descriptor;
+
+	// Props cache their descriptor, other objects are resolved every time
+	AGGTProp* Prop = AGGTProp::FromComponent(Component);
+	if (Prop)
+	{
+		if (Prop->GetImpulseDescriptor(ImpulseProfiles, Descriptor))
+			return Descriptor;
+	}
+	else if (ImpulseProfiles && ImpulseProfiles->Resolve(Component, Descriptor))
+	{
+		return Descriptor;
+	}
+
+	// No profile matched, every object leaves at the same speed
+	Descriptor.LaunchSpeed = ImpulsePower;
+	Descriptor.SpinSpeed = 0.0f;
+	return Descriptor;
+}
+
+FVector AGravityGun::GetLaunchVelocity(const FGGTImpulseDescriptor& Descriptor) const
+{
+	return MuzzleLocation->GetForwardVector() * Descriptor.LaunchSpeed;
+}
+
+void AGravityGun::LaunchComponent(UPrimitiveComponent* Component, const FGGTImpulseDescriptor& Descriptor)
+{
+	// A dormant prop has to start replicating before it flies off
+	if (AGGTProp* Prop = AGGTProp::FromComponent(Component))
+		Prop->WakeReplication();
+
+	// Replace the velocity, so the launch speed is the same for every mass and whatever the object was doing before
+	Component->SetAllPhysicsLinearVelocity(GetLaunchVelocity(Descriptor));
+
+	// Tumble forward around the right axis of the muzzle
+	if (Descriptor.SpinSpeed != 0.0f)
+		Component->SetAllPhysicsAngularVelocity(MuzzleLocation->GetRightVector() * Descriptor.SpinSpeed);
+}
+
+void AGravityGun::UpdateTrajectory()
+{
+	UPrimitiveComponent* HeldComp = PhysicsHandle->GetGrabbedComponent();
+
+	const FVector MuzzlePosition = MuzzleLocation->GetComponentLocation();
+	const FVector MuzzleDirection = MuzzleLocation->GetForwardVector();
+
+	// A new object makes the old prediction wrong, so it restarts right away.
+	// Otherwise the arc that is being swept is finished first, so a player that keeps moving still gets complete arcs.
+	const bool bSameComponent = TrajectoryComponent.Get() == HeldComp;
+	if (bSameComponent && (PendingSweepSegment != INDEX_NONE || GetWorld()->GetTimeSeconds() - TrajectoryComputeTime < TrajectoryRecomputeInterval))
+		return;
+
+	// Only recompute the arc when the muzzle changed enough to matter
+	const bool bMoved = FVector::DistSquared(MuzzlePosition, TrajectoryMuzzleLocation) > FMath::Square(TrajectoryRecomputeDistance);
+	const bool bTurned = FVector::DotProduct(MuzzleDirection, TrajectoryMuzzleDirection) < FMath::Cos(FMath::DegreesToRadians(TrajectoryRecomputeAngle));
+
+	if (bSameComponent && !bMoved && !bTurned)
+		return;
+
+	TrajectoryMuzzleLocation = MuzzlePosition;
+	TrajectoryMuzzleDirection = MuzzleDirection;
+	TrajectoryComputeTime = GetWorld()->GetTimeSeconds();
+
+	if (!bSameComponent)
+	{
+		// A new object, the old prediction does not apply anymore
+		bHasPredictedTrajectory = false;
+		TrajectoryComponent = HeldComp;
+
+		*TrajectoryParams = GetTraceParams();
+		TrajectoryParams->TraceTag = FName(TEXT("Gravity Trajectory"));
+		TrajectoryParams->AddIgnoredComponent(HeldComp);
+		TrajectoryParams->AddIgnoredActor(HeldComp->GetOwner());
+	}
+
+	// The same launch velocity Fire would give the object
+	const FVector LaunchVelocity = GetLaunchVelocity(HeldDescriptor);
+	const FVector Gravity(0.0f, 0.0f, GetWorld()->GetGravityZ());
+	const FVector StartLocation = HeldComp->GetComponentLocation();
+
+	// Integrate the arc, the sweeps are done later by the query scheduler
+	const int32 NumPoints = FMath::CeilToInt(TrajectoryMaxTime / TrajectoryTimeStep) + 1;
+
+	PendingTrajectory.Points.Reset(NumPoints);
+	PendingTrajectory.bHasImpact = false;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const float Time = FMath::Min(i * TrajectoryTimeStep, TrajectoryMaxTime);
+		PendingTrajectory.Points.Add(StartLocation + (LaunchVelocity * Time) + (0.5f * Gravity * Time * Time));
+	}
+
+	PendingSweepSegment = 0;
+}
+
+int32 AGravityGun::RunScheduledQueries(int32 Budget)
+{
+	UPrimitiveComponent* HeldComp = TrajectoryComponent.Get();
+	if (PendingSweepSegment == INDEX_NONE || HeldComp == nullptr || !TrajectoryParams.IsValid())
+		return 0;
+
+	// Sweep with the bounds of the held object, using the same collision responses as the object itself
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(HoldRadius);
+	const FCollisionResponseParams ResponseParams(HeldComp->GetCollisionResponseToChannels());
+	const ECollisionChannel Channel = HeldComp->GetCollisionObjectType();
+
+	int32 QueriesRun = 0;
+	while (QueriesRun < Budget && PendingSweepSegment < PendingTrajectory.Points.Num() - 1)
+	{
+		const FVector SegmentStart = PendingTrajectory.Points[PendingSweepSegment];
+		const FVector SegmentEnd = PendingTrajectory.Points[PendingSweepSegment + 1];
+
+		FHitResult hitResult(ForceInit);
+		QueriesRun++;
+
+		if (GetWorld()->SweepSingleByChannel(hitResult, SegmentStart, SegmentEnd, FQuat::Identity, Channel, Shape, *TrajectoryParams, ResponseParams))
+		{
+			// Cut the arc at the first impact
+			PendingTrajectory.Points.SetNum(PendingSweepSegment + 1);
+			PendingTrajectory.Points.Add(hitResult.Location);
+			PendingTrajectory.bHasImpact = true;
+			PendingTrajectory.ImpactPoint = hitResult.ImpactPoint;
+			PendingTrajectory.ImpactNormal = hitResult.ImpactNormal;
+			break;
+		}
+
+		PendingSweepSegment++;
+	}
+
+	// Publish the arc once every segment has been swept or it hit something
+	if (PendingTrajectory.bHasImpact || PendingSweepSegment >= PendingTrajectory.Points.Num() - 1)
+	{
+		PredictedTrajectory = PendingTrajectory;
+		bHasPredictedTrajectory = true;
+		PendingSweepSegment = INDEX_NONE;
+
+#if ENABLE_DRAW_DEBUG
+		if (bDrawTrajectory)
+		{
+			for (int32 i = 0; i < PredictedTrajectory.Points.Num() - 1; i++)
+			{
+				DrawDebugLine(GetWorld(), PredictedTrajectory.Points[i], PredictedTrajectory.Points[i + 1], FColor::Cyan, false, 0.1f);
+			}
+
+			if (PredictedTrajectory.bHasImpact)
+				DrawDebugSphere(GetWorld(), PredictedTrajectory.ImpactPoint, 10.0f, 8, FColor::Red, false, 0.1f);
+		}
+#endif
+	}
+
+	return QueriesRun;
+}
+
+void AGravityGun::ClearTrajectory()
+{
+	TrajectoryComponent.Reset();
+	PendingTrajectory.Points.Reset();
+	PendingSweepSegment = INDEX_NONE;
+	bHasPredictedTrajectory = false;
+}
+
+bool AGravityGun::GetPredictedTrajectory(FGravityTrajectory& OutTrajectory) const
+{
+	if (!bHasPredictedTrajectory)
+		return false;
+
+	OutTrajectory = PredictedTrajectory;
+	return true;
+}
+
+bool AGravityGun::GetPredictedImpact(FVector& OutImpactPoint) const
+{
+	if (!bHasPredictedTrajectory || !PredictedTrajectory.bHasImpact)
+		return false;
+
+	OutImpactPoint = PredictedTrajectory.ImpactPoint;
+	return true;
 }
 
 void AGravityGun::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	// Clear the timer
-	GetWorld()->GetTimerManager().ClearTimer(BurstTimerHandle);
+	// Same teardown as a drop: release the held and pulled objects so their collision and the shared path are restored,
+	// unbind from the clock and its tick prerequisite and leave the query scheduler
+	DestroyHeldState();
+
+	Super::EndPlay(EndPlayReason);
 }
\ No newline at end of file
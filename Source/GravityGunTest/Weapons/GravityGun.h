@@ -3,14 +3,68 @@
 #pragma once
 
 #include "Weapons/WeaponBase.h"
+#include "General/GGTQueryScheduler.h"
+#include "General/GGTImpulseProfileSet.h"
 #include "GravityGun.generated.h"
 
 
+class UGGTFixedStepClock;
+
+
+/** The predicted path of the held object if the gun would fire now */
+USTRUCT(BlueprintType)
+struct FGravityTrajectory
+{
+	GENERATED_BODY()
+
+	/** Points along the arc, from the held object to the impact point or the end of the prediction */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory")
+	TArray<FVector> Points;
+
+	/** If the arc hits something within the prediction time */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory")
+	bool bHasImpact;
+
+	/** Where the held object would first hit something */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory")
+	FVector ImpactPoint;
+
+	/** The surface normal at the impact point */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory")
+	FVector ImpactNormal;
+
+	FGravityTrajectory()
+		: bHasImpact(false)
+		, ImpactPoint(ForceInit)
+		, ImpactNormal(ForceInit)
+	{
+	}
+};
+
+
+/** How the gravity gun controls the rotation of the held object */
+UENUM(BlueprintType)
+enum class EGravityHoldMode : uint8
+{
+	/** Only the location is controlled, the object turns freely */
+	HM_Free				UMETA(DisplayName = "Free"),
+
+	/** The object faces the same way as the view */
+	HM_AlignToView		UMETA(DisplayName = "Align To View"),
+
+	/** The object keeps the rotation relative to the view it had when it was grabbed */
+	HM_KeepRelative		UMETA(DisplayName = "Keep Relative"),
+
+	/** Like keep relative, and the player can turn the object with the rotate input */
+	HM_PlayerRotate		UMETA(DisplayName = "Player Rotate")
+};
+
+
 /**
  * 
  */
 UCLASS()
-class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase
+class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase, public IGGTQueryClient
 {
 	GENERATED_BODY()
 
@@ -18,18 +72,60 @@ class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase
 	
 		AGravityGun();
 
-		/** The component used for the gravity effect when picking up objects */
-		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gravity Gun")
+		/** The component used for the gravity effect when picking up objects, only exists while the gun is held */
+		UPROPERTY(Transient, BlueprintReadOnly, Category = "Gravity Gun")
 		UPhysicsHandleComponent* PhysicsHandle;
 
-		/** The particle effect that is used when the gravity gun fires */
-		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gravity Gun")
+		/** The particle effect that is used when the gravity gun fires, only exists while the gun is held */
+		UPROPERTY(Transient, BlueprintReadOnly, Category = "Gravity Gun")
 		UParticleSystemComponent* BurstParticleComponent;
 
-		/** The particle effect that is used when the gravity gun is grabbing an object */
-		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gravity Gun")
+		/** The particle effect that is used when the gravity gun is grabbing an object, only exists while the gun is held */
+		UPROPERTY(Transient, BlueprintReadOnly, Category = "Gravity Gun")
 		UParticleSystemComponent* PullParticleComponent;
 
+		/** The templates of the particle components that are created when the gun is picked up */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun")
+		UParticleSystem* BurstParticle;
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun")
+		UParticleSystem* PullParticle;
+
+#if WITH_EDITORONLY_DATA
+		/** The particle components the templates were set on before they were created on pickup, only loaded to move the templates in PostLoad.
+		*	Editor only, so cooked weapons don't have them. Can be removed once every gravity gun blueprint is resaved.
+		*/
+		UPROPERTY()
+		UParticleSystemComponent* BurstParticleComponent_DEPRECATED;
+		UPROPERTY()
+		UParticleSystemComponent* PullParticleComponent_DEPRECATED;
+#endif
+
+		/** How long the burst effect plays when the gun fires */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun", meta = (ClampMin = "0.0"))
+		float BurstDuration;
+
+		/** The settings of the physics handle that is created when the gun is picked up */
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun")
+		float HoldLinearDamping;
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun")
+		float HoldInterpolationSpeed;
+
+
+		/** How the rotation of the held object is controlled */
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gravity Gun|Rotation")
+		EGravityHoldMode HoldMode;
+
+		/** Degrees the held object turns for every unit of rotate input */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Rotation")
+		float HoldRotateSpeed;
+
+		/** Changes the hold mode, an object that is held is grabbed again with the new mode */
+		UFUNCTION(BlueprintCallable, Category = "Gravity Gun|Rotation")
+		void SetHoldMode(EGravityHoldMode NewHoldMode);
+
+		/** Turns the held object in player rotate mode */
+		virtual void AddHoldRotationInput(float Yaw, float Pitch) override;
+
 
 		/** How long the trace used for grabbing and shooting away physics objects is */
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
@@ -42,13 +138,18 @@ class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
 		float MaxObjectDistance;
 
-		/** How large the impulse should be when left clicking to fire 
-		*	The end impulse is gotten from ImpulsePower * Mass
-		*	Mass being that of the object that is being shot.
+		/** The speed objects leave the gun with when left clicking to fire, in cm/s.
+		*	Only used for objects that no impulse profile matches.
 		*/
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
 		float ImpulsePower;
 
+		/** How objects are launched by physical material and mass class.
+		*	Leave empty to launch every object at ImpulsePower.
+		*/
+		UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity Gun")
+		UGGTImpulseProfileSet* ImpulseProfiles;
+
 		/** Time between the weapon can fire it's impulses */
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
 		float FireCooldown;
@@ -66,6 +167,70 @@ class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase
 		TSubclassOf<UCameraShake> CameraShake;
 
 
+		/** If objects far away from the gun should be pulled in over time instead of grabbed where they are */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Tractor")
+		bool bTractorPull;
+
+		/** Objects closer to the hold point than this are grabbed directly, objects further away are pulled in first.
+		*	This is also how close a held object has to be to the hold point for Fire to launch it.
+		*/
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Tractor", meta = (ClampMin = "0.0"))
+		float TractorGrabDistance;
+
+		/** The speed the pulled object moves toward the gun with */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Tractor", meta = (ClampMin = "0.0"))
+		float TractorPullSpeed;
+
+		/** The highest acceleration the pull can give. The force is this times the mass of the object, so heavy objects are not yanked. */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Tractor", meta = (ClampMin = "0.0"))
+		float TractorMaxAcceleration;
+
+		/** How long the gun keeps pulling before giving up, for example when the object is stuck */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Tractor", meta = (ClampMin = "0.0"))
+		float TractorTimeout;
+
+
+		/** If the gun should predict where the held object will go when fired */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory")
+		bool bPredictTrajectory;
+
+		/** Draws the predicted trajectory with debug lines, not available in shipping builds */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory")
+		bool bDrawTrajectory;
+
+		/** How many seconds of flight the prediction covers */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory", meta = (ClampMin = "0.1"))
+		float TrajectoryMaxTime;
+
+		/** The time between two points on the predicted arc. Every segment costs one sweep. */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory", meta = (ClampMin = "0.01"))
+		float TrajectoryTimeStep;
+
+		/** How far the muzzle has to move before the arc is recomputed */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory")
+		float TrajectoryRecomputeDistance;
+
+		/** How many degrees the muzzle has to turn before the arc is recomputed */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory")
+		float TrajectoryRecomputeAngle;
+
+		/** The shortest time between two recomputes of the arc for the same object, an arc that is being swept is always finished first */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun|Trajectory", meta = (ClampMin = "0.0"))
+		float TrajectoryRecomputeInterval;
+
+
+		/** Get the latest finished trajectory prediction, returns false if there is none */
+		UFUNCTION(BlueprintCallable, Category = "Gravity Gun|Trajectory")
+		bool GetPredictedTrajectory(FGravityTrajectory& OutTrajectory) const;
+
+		/** Get the point where the held object would first hit something when fired, returns false if there is no impact */
+		UFUNCTION(BlueprintCallable, Category = "Gravity Gun|Trajectory")
+		bool GetPredictedImpact(FVector& OutImpactPoint) const;
+
+		/** Runs the pending trajectory sweeps, called by the query scheduler */
+		virtual int32 RunScheduledQueries(int32 Budget) override;
+
+
 		/** Fires the weapon, returns true if the weapon was successfully fired
 		*	Takes the start location of the trace and the direction as parameter.
 		*	This is done to match the crosshair to what you are hitting.
@@ -84,19 +249,154 @@ class GRAVITYGUNTEST_API AGravityGun : public AWeaponBase
 		UFUNCTION(BlueprintCallable, Category = "Weapon")
 		virtual void DropWeapon() override;
 
+		/** Asks the holder to trace for objects that can be grabbed */
+		virtual FWeaponTargetingInfo GetTargetingInfo() const override;
+
+		/** The cooldown of Fire, shared with the server when the owning client predicts */
+		virtual float GetFireDelay() const override;
+		virtual void SetFireDelay(float NewFireDelay) override;
+
+		/** The grabbed or pulled object */
+		virtual void GetHeldObject(UPrimitiveComponent*& OutComponent, bool& bOutPulling) const override;
+
+		/** Releases what the client holds and grabs or pulls what the server holds, if they are not the same */
+		virtual bool ReconcileHeldObject(UPrimitiveComponent* ServerComponent, bool bServerPulling) override;
+
+		/** If the component is a physics object the gravity gun can grab and fire, weapons are excluded */
+		static bool IsGrabbable(const UPrimitiveComponent* Component);
+
+		/** The radius of the component from its local bounds, it doesn't change when the component turns.
+		*	Used for the hold offset and the pull path, so both treat the object as the same size.
+		*/
+		static float GetLocalRadius(const UPrimitiveComponent* Component);
+
+		/** Lets go of the held object when the gun is put away */
+		virtual void SetWeaponActive(bool bNewActive) override;
+
 
 	protected:
 
 		float CurrentFireDelay;
 
-		/** Trace parameters for the line trace used for grabbing objects, or firing */
-		FCollisionQueryParams TraceParams;
+		/** Trace parameters for the trajectory sweeps, they also ignore the held object. nullptr while the gun is free. */
+		TUniquePtr<FCollisionQueryParams> TrajectoryParams;
+
+		/** The part of the trace parameters that is the same for every gun, so the guns share it */
+		static const FCollisionQueryParams& GetGravityTraceParams();
+
+		/** Get the trace parameters for grabbing objects, or firing, they ignore the gun and its current holder */
+		FCollisionQueryParams GetTraceParams() const;
+
+		/** Creates the components, query parameters and bindings the gun needs while it's held, and destroys them when it's dropped */
+		virtual void OnStateChanged(EWeaponStates NewState) override;
+		void CreateHeldState();
+		void DestroyHeldState();
+
+		/** Creates a particle component at the muzzle, returns nullptr if there is no template */
+		UParticleSystemComponent* CreateParticleComponent(UParticleSystem* Template);
+
+		/** If the pull effect is playing. It follows the holding and pulling state, and is only changed on grab, release and pull transitions. */
+		bool bPullEffectActive;
+
+		/** Starts or stops the pull effect if holding or pulling changed since it was last updated */
+		void UpdatePullEffect();
+
+		/** Line traces for an object to grab or fire at.
+		*	When the fire is rewound the props are also traced as they were at that time, and the closest hit is used.
+		*/
+		bool TraceForTarget(const FVector& TraceStart, const FVector& Direction, FHitResult& OutHit) const;
+
+		/** Calculates where the provided component should be held */
+		FVector GetHoldTargetLocation(UPrimitiveComponent* Component) const;
 
-		/** Handle to manage the timer that calls the burst deactivate system
-		*	Which deactivates the burst particle system
+		/** The local radius of the held or pulled object, cached when it's picked */
+		float HoldRadius;
+
+		/** The rotation of the held object relative to the muzzle */
+		FQuat HoldRotation;
+
+		/** Releases the held object, if there is one, and scales its velocity */
+		void ReleaseHeldObject(float VelocityScale);
+
+		/** Makes the held object and the capsule of the holder ignore each other when moving, and undoes it.
+		*	The object keeps blocking ECC_Pawn, so other pawns still collide with it and its collision filter is never rebuilt.
+		*	The hold target keeps the object in front of the muzzle, clear of the capsule, so the solver has no contact to resolve with the holder.
+		*	Only the ignores that were added by the grab are removed again.
 		*/
-		FTimerHandle BurstTimerHandle;
-		void BurstSystemDeactivate();
+		void BeginHoldCollision(UPrimitiveComponent* Component);
+		void EndHoldCollision(UPrimitiveComponent* Component);
+
+		/** The holder the held object ignores, and which of the ignores the grab added */
+		TWeakObjectPtr<APawn> HoldCollisionHolder;
+		bool bHoldAddedObjectIgnore;
+		bool bHoldAddedHolderIgnore;
+
+		/** Grabs the component with the physics handle and plays the pull sound */
+		void GrabComponent(UPrimitiveComponent* Component);
+
+		/** The object that is being pulled in tractor mode, when the pull started and the point on its path it's pulled toward */
+		TWeakObjectPtr<UPrimitiveComponent> TractorComponent;
+		float TractorStartTime;
+		FVector TractorWaypoint;
+
+		/** Starts/stops pulling the component in tractor mode */
+		void StartTractorPull(UPrimitiveComponent* Component);
+		void StopTractorPull();
+
+		/** Picks the next point on the path of the pulled object, and grabs it when it's close enough or gives up */
+		void UpdateTractorPull(float DeltaTime);
+
+		/** Pushes the pulled object toward the waypoint, called once every frame since the force lasts one physics frame */
+		void ApplyTractorForce(float DeltaTime);
+
+		/** Get what Fire does to the provided component, from the cache of the prop if it is one */
+		FGGTImpulseDescriptor GetImpulseDescriptor(UPrimitiveComponent* Component) const;
+
+		/** The descriptor of the held object, resolved when it's grabbed */
+		FGGTImpulseDescriptor HeldDescriptor;
+
+		/** Calculates the velocity Fire gives to an object with the provided descriptor */
+		FVector GetLaunchVelocity(const FGGTImpulseDescriptor& Descriptor) const;
+
+		/** Launches the component out of the muzzle as a velocity change, with the spin of the descriptor */
+		void LaunchComponent(UPrimitiveComponent* Component, const FGGTImpulseDescriptor& Descriptor);
+
+		/** The last finished trajectory, and if it is still valid */
+		FGravityTrajectory PredictedTrajectory;
+		bool bHasPredictedTrajectory;
+
+		/** The arc that is currently being swept, and the next segment to sweep */
+		FGravityTrajectory PendingTrajectory;
+		int32 PendingSweepSegment;
+
+		/** The muzzle pose, held component and time the pending arc was computed from */
+		float TrajectoryComputeTime;
+		FVector TrajectoryMuzzleLocation;
+		FVector TrajectoryMuzzleDirection;
+		TWeakObjectPtr<UPrimitiveComponent> TrajectoryComponent;
+
+		/** Recomputes the arc if the held object changed, or the muzzle changed more than the thresholds once the pending arc is finished */
+		void UpdateTrajectory();
+
+		/** Clears both the pending and finished trajectory */
+		void ClearTrajectory();
+
+		/** The clock the gameplay logic runs on, nullptr if the world doesn't have one and the logic runs every frame */
+		UPROPERTY()
+		UGGTFixedStepClock* FixedStepClock;
+		FDelegateHandle FixedStepHandle;
+
+		/** The hold target and rotation of the last two gameplay steps, the frame tick blends between them */
+		FVector PreviousHoldTarget;
+		FVector CurrentHoldTarget;
+		FQuat PreviousHoldRotation;
+		FQuat CurrentHoldRotation;
+
+		/** Gameplay logic that runs on the fixed step: cooldown, hold target, distance release, pulling and trajectory checks */
+		void FixedTick(float StepTime);
+
+		/** Moves the particle templates of blueprints saved with the old particle components */
+		virtual void PostLoad() override;
 
 		/** Called when the game starts or when spawned */
 		virtual void BeginPlay() override;
@@ -3,6 +3,9 @@
 #include "GravityGunTest.h"
 #include "WeaponBase.h"
 
+#include "General/GGTGameState.h"
+#include "Net/UnrealNetwork.h"
+
 
 // Sets default values
 AWeaponBase::AWeaponBase()
@@ -20,6 +23,20 @@ AWeaponBase::AWeaponBase()
 	MuzzleLocation->SetupAttachment(WeaponMesh);
 
 	StartState = EWeaponStates::WS_Free;
+	bWeaponActive = true;
+	FireRewindTime = -1.0f;
+
+	// The server owns the weapons, a held weapon is relevant wherever its holder is
+	bReplicates = true;
+	bReplicateMovement = true;
+	bNetUseOwnerRelevancy = true;
+}
+
+void AWeaponBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AWeaponBase, CurrentState);
 }
 
 // Called when the game starts or when spawned
@@ -27,8 +44,8 @@ void AWeaponBase::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	// Set the start state
-	SetState(StartState);
+	// Set the start state, clients use the state the server sent with the weapon
+	SetState(HasAuthority() ? StartState : CurrentState);
 }
 
 // Called every frame
@@ -40,17 +57,11 @@ void AWeaponBase::Tick(float DeltaTime)
 
 bool AWeaponBase::Fire(FVector TraceStart, FVector Direction)
 {
-	if (GEngine)
-		GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, "Base Weapon - Fire");
-
 	return false;
 }
 
 bool AWeaponBase::AltFire(FVector TraceStart, FVector Direction)
 {
-	if(GEngine)
-		GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, "Base Weapon - Alt Fire");
-
 	return false;
 }
 
@@ -73,6 +84,21 @@ void AWeaponBase::SetState(EWeaponStates NewState)
 			WeaponMesh->SetCollisionProfileName("NoCollision");
 			break;
 	};
+
+	// Free weapons have nothing to do every frame
+	SetActorTickEnabled(NewState == EWeaponStates::WS_Held && bWeaponActive);
+
+	OnStateChanged(NewState);
+}
+
+void AWeaponBase::OnRep_CurrentState()
+{
+	SetState(CurrentState);
+}
+
+void AWeaponBase::OnStateChanged(EWeaponStates NewState)
+{
+
 }
 
 EWeaponStates AWeaponBase::GetState()
@@ -83,4 +109,103 @@ EWeaponStates AWeaponBase::GetState()
 void AWeaponBase::DropWeapon()
 {
 
-}
\ No newline at end of file
+}
+
+void AWeaponBase::SetHolder(APawn* NewHolder)
+{
+	// The holder is the owner, so it also owns the weapon on the network
+	SetOwner(NewHolder);
+	Instigator = NewHolder;
+}
+
+APawn* AWeaponBase::GetHolder() const
+{
+	return Cast<APawn>(GetOwner());
+}
+
+void AWeaponBase::AddHoldRotationInput(float Yaw, float Pitch)
+{
+
+}
+
+float AWeaponBase::GetFireDelay() const
+{
+	return 0.0f;
+}
+
+void AWeaponBase::SetFireDelay(float NewFireDelay)
+{
+
+}
+
+void AWeaponBase::GetHeldObject(UPrimitiveComponent*& OutComponent, bool& bOutPulling) const
+{
+	OutComponent = nullptr;
+	bOutPulling = false;
+}
+
+bool AWeaponBase::ReconcileHeldObject(UPrimitiveComponent* ServerComponent, bool bServerPulling)
+{
+	return false;
+}
+
+FWeaponTargetingInfo AWeaponBase::GetTargetingInfo() const
+{
+	return FWeaponTargetingInfo();
+}
+
+void AWeaponBase::SetWeaponActive(bool bNewActive)
+{
+	if (bWeaponActive == bNewActive)
+		return;
+
+	bWeaponActive = bNewActive;
+
+	// Only flip visibility and ticking, the weapon stays attached with the held collision settings
+	SetActorHiddenInGame(!bNewActive);
+	SetActorTickEnabled(bNewActive);
+}
+
+bool AWeaponBase::IsWeaponActive() const
+{
+	return bWeaponActive;
+}
+
+void AWeaponBase::SetFireRewindTime(float WorldTime)
+{
+	FireRewindTime = WorldTime;
+}
+
+void AWeaponBase::PrefetchAssets()
+{
+	// Gather the assets that are not loaded yet
+	TArray<FStringAssetReference> AssetsToLoad;
+	for (const TAssetPtr<UObject>& Asset : PrefetchAssetList)
+	{
+		if (!Asset.IsNull() && !Asset.IsValid())
+			AssetsToLoad.Add(Asset.ToStringReference());
+	}
+
+	if (AssetsToLoad.Num() == 0)
+	{
+		OnAssetsPrefetched();
+		return;
+	}
+
+	// The streamable manager lives on the game state, so it only exists while UObjects do
+	AGGTGameState* GameState = AGGTGameState::Get(this);
+	if (GameState == nullptr)
+		return;
+
+	GameState->StreamableManager.RequestAsyncLoad(AssetsToLoad, FStreamableDelegate::CreateUObject(this, &AWeaponBase::OnAssetsPrefetched));
+}
+
+void AWeaponBase::OnAssetsPrefetched()
+{
+	// Keep the loaded assets alive for as long as the weapon exists
+	for (const TAssetPtr<UObject>& Asset : PrefetchAssetList)
+	{
+		if (Asset.IsValid())
+			PrefetchedAssets.AddUnique(Asset.Get());
+	}
+}
@@ -21,6 +21,30 @@ enum class EWeaponType : uint8
 	WT_GravityGun	UMETA(DisplayName = "Gravity Gun")
 };
 
+/** What a weapon needs from its holder every frame.
+*	The holder asks for it once when the weapon is equipped and keeps a copy, so the per frame checks don't depend on the weapon type.
+*/
+struct FWeaponTargetingInfo
+{
+	/** If the holder should trace for objects the weapon can interact with, to show the crosshair alert */
+	bool bHoverTrace;
+
+	/** How long the hover trace is */
+	float HoverTraceLength;
+
+	/** Decides if the component hit by the hover trace is something the weapon can interact with.
+	*	A plain function instead of a virtual so that the check is cheap and the same for every weapon of the type.
+	*/
+	bool (*IsHoverTarget)(const UPrimitiveComponent* Component);
+
+	FWeaponTargetingInfo()
+		: bHoverTrace(false)
+		, HoverTraceLength(0.0f)
+		, IsHoverTarget(nullptr)
+	{
+	}
+};
+
 UCLASS()
 class GRAVITYGUNTEST_API AWeaponBase : public AActor
 {
@@ -85,13 +109,98 @@ class GRAVITYGUNTEST_API AWeaponBase : public AActor
 		UFUNCTION(BlueprintCallable, Category = "Weapon")
 		virtual void DropWeapon();
 
+		/** Sets the pawn holding the weapon, nullptr when the weapon is dropped.
+		*	Override in childs to update anything that depends on the holder, like what the traces ignore.
+		*/
+		virtual void SetHolder(APawn* NewHolder);
+
+		/** Get the pawn holding the weapon, nullptr if the weapon is free */
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		APawn* GetHolder() const;
+
+		/** Rotate input from the holder, for weapons that can turn what they hold. The default does nothing. */
+		virtual void AddHoldRotationInput(float Yaw, float Pitch);
+
+		/** Get and set the time left until the weapon can fire again.
+		*	The owning client predicts fires with its own copy of the weapon, the server sends its cooldown back so the two agree.
+		*/
+		virtual float GetFireDelay() const;
+		virtual void SetFireDelay(float NewFireDelay);
+
+		/** Get the object the weapon holds or pulls, and if it's being pulled. The default holds nothing. */
+		virtual void GetHeldObject(UPrimitiveComponent*& OutComponent, bool& bOutPulling) const;
+
+		/** Makes the weapon hold the same object as the server, called on the owning client when the server answers a predicted action.
+		*	Returns true if the prediction was wrong and the weapon had to be corrected.
+		*/
+		virtual bool ReconcileHeldObject(UPrimitiveComponent* ServerComponent, bool bServerPulling);
+
+		/** Get what the weapon needs from its holder every frame, called once when the weapon is equipped.
+		*	Override in childs that want a crosshair alert, the default asks for nothing.
+		*/
+		virtual FWeaponTargetingInfo GetTargetingInfo() const;
+
+		/** Shows or hides a held weapon that sits in an inventory slot.
+		*	Only visibility and ticking are changed, collision and physics stay as they were set by SetState.
+		*	Override in childs to stop weapon specific work while the weapon is put away.
+		*/
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		virtual void SetWeaponActive(bool bNewActive);
+
+		/** If the weapon is the one currently in use by its holder */
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		bool IsWeaponActive() const;
+
+		/** Starts loading the assets in PrefetchAssetList in the background.
+		*	Called on the weapon in the next inventory slot so that switching to it doesn't hitch.
+		*/
+		UFUNCTION(BlueprintCallable, Category = "Weapon")
+		virtual void PrefetchAssets();
+
+		/** Sets the world time the holder saw when it fired.
+		*	Used on the server to trace against the world as a remote client saw it, set a negative value to trace against the current world.
+		*/
+		void SetFireRewindTime(float WorldTime);
+
+
+		/** Assets that are loaded by PrefetchAssets before the weapon is switched to */
+		UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+		TArray<TAssetPtr<UObject>> PrefetchAssetList;
+
+		/** Replicates the state of the weapon */
+		virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 
 	protected:
 
-		/** The current state the weapon is in, if it's being held by a character or free in the world. */
-		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
+		/** The current state the weapon is in, if it's being held by a character or free in the world.
+		*	The server decides it, clients apply the collision and physics of the state when it arrives.
+		*/
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_CurrentState, Category = "Weapon")
 		EWeaponStates CurrentState;
 
+		/** Applies the state the server set */
+		UFUNCTION()
+		void OnRep_CurrentState();
+
+		/** The world time the fire traces should be rewound to, negative when not rewinding */
+		float FireRewindTime;
+
+		/** If the weapon is shown and ticking, false while it's stored in an inventory slot */
+		bool bWeaponActive;
+
+		/** Hard references to the prefetched assets so they are not garbage collected */
+		UPROPERTY(Transient)
+		TArray<UObject*> PrefetchedAssets;
+
+		/** Called when the assets requested by PrefetchAssets have finished loading */
+		void OnAssetsPrefetched();
+
+		/** Called by SetState after the collision and physics are set.
+		*	Override in childs to create or free what the weapon only needs while it's held.
+		*/
+		virtual void OnStateChanged(EWeaponStates NewState);
+
 
 		/** Called when the game starts or when spawned */
 		virtual void BeginPlay() override;